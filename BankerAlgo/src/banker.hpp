@@ -0,0 +1,181 @@
+#ifndef BANKER_HPP
+#define BANKER_HPP
+
+#include "utils.hpp"
+#include "matrix.hpp"
+#include "safety.hpp"
+#include "metrics.hpp"
+#include <iostream>
+#include <vector>
+#include <queue>
+
+
+enum class result {
+    FAIL    = 0,
+    WAIT    = 1,
+    SUCCESS = 2
+};
+
+// 原循环队列版安全性算法，保留作为 SafetyChecker 的对照实现
+bool is_safe_queue(
+    const std::vector<int>& available,
+    const std::vector<std::vector<int>>& allocation,
+    const std::vector<std::vector<int>>& need
+) {
+    DEBUG_PRINT("Checking if the system is in a safe state...");
+
+    std::vector<int> work = available;
+    std::queue<std::pair<int, int>> unfinished;
+    for (std::size_t i = 0; i < allocation.size(); ++i) {
+        unfinished.push(std::make_pair(i, 0));
+    }
+    DEBUG_PRINT("\tAllocation: " << allocation);
+    DEBUG_PRINT("\tNeed      : " << need);
+    DEBUG_PRINT("\tWork      : " << available);
+
+    int task_count = 0;
+    while (!unfinished.empty()) {
+        int id = unfinished.front().first;
+        int count = unfinished.front().second;
+        if (task_count < count) {
+            DEBUG_PRINT("System is not in a safe state.");
+            DEBUG_PRINT("\tRemaining : " << unfinished);
+            return false;
+        }
+        unfinished.pop();
+
+        if (need[id] <= work) {
+            work += allocation[id];
+            ++task_count;
+            DEBUG_PRINT("\t\tTask " << id << " finished, work updated. \tTag: " << count << ",\ttasks finished: " << task_count);
+            DEBUG_PRINT("\tWork      : " << work);
+        } else {
+            unfinished.push(std::make_pair(id, task_count + 1));
+            DEBUG_PRINT("\t\tTask " << id << " cannot finish, skipped. \tTag: " << task_count + 1 << ",\ttasks finished: " << task_count);
+        }
+    }
+
+    DEBUG_PRINT("System is in a safe state.");
+    return true;
+}
+
+
+bool is_safe(
+    const ResourceVector& available,
+    const ResourceMatrix& allocation,
+    const ResourceMatrix& need
+) {
+    thread_local SafetyChecker checker;
+    return checker.is_safe(available, allocation, need);
+}
+
+
+result allocate_decision(
+    ResourceVector& available,
+    ResourceMatrix& allocation,
+    ResourceMatrix& need,
+    const ResourceVector& request,
+    int request_id
+) {
+    if (request.empty()) {
+        DEBUG_PRINT("No resources requested.");
+        return result::SUCCESS;
+    }
+    const std::size_t stride = available.stride();
+    int* alloc_row = allocation.row(request_id);
+    int* need_row = need.row(request_id);
+    if (!vec_le(request.data(), need_row, stride)) {
+        DEBUG_PRINT("Request exceeds need.");
+        return result::FAIL;
+    }
+    if (!vec_le(request.data(), available.data(), stride)) {
+        DEBUG_PRINT("Request exceeds available resources.");
+        return result::WAIT;
+    }
+
+    apply_request(available.data(), alloc_row, need_row, request.data(), stride);
+
+    if (!is_safe(available, allocation, need)) {
+        revert_request(available.data(), alloc_row, need_row, request.data(), stride);
+        DEBUG_PRINT("Request cannot be granted, system is not in a safe state.");
+        return result::WAIT;
+    }
+
+    DEBUG_PRINT("Request granted.");
+    return result::SUCCESS;
+}
+
+// 按银行家算法处理进程 request_id 的请求，并记录决策次数与耗时
+result banker_allocate(
+    ResourceVector& available,
+    ResourceMatrix& allocation,
+    ResourceMatrix& need,
+    const ResourceVector& request,
+    int request_id
+) {
+    const auto start = metrics_clock::now();
+    result res = allocate_decision(available, allocation, need, request, request_id);
+    banker_metrics.record_decision(static_cast<int>(res), elapsed_ns(start));
+    return res;
+}
+
+
+bool banker_release(
+    ResourceVector& available,
+    ResourceMatrix& allocation,
+    ResourceMatrix& need,
+    const ResourceVector& release,
+    int release_id
+) {
+    const std::size_t stride = available.stride();
+    int* alloc_row = allocation.row(release_id);
+    if (!vec_le(release.data(), alloc_row, stride)) {
+        DEBUG_PRINT("Release exceeds allocation.");
+        return false;
+    }
+    revert_request(available.data(), alloc_row, need.row(release_id), release.data(), stride);
+    DEBUG_PRINT("Resources released.");
+    return true;
+}
+
+
+const char* result_name(result res) {
+    switch (res) {
+        case result::FAIL:
+            return "FAIL";
+        case result::WAIT:
+            return "WAIT";
+        case result::SUCCESS:
+            return "SUCCESS";
+    }
+    return "UNKNOWN";
+}
+
+
+bool check_state(
+    const std::vector<int>& available,
+    const std::vector<std::vector<int>>& allocation,
+    const std::vector<std::vector<int>>& need
+) {
+    if (allocation.size() != need.size()) {
+        std::cerr << "Allocation and Need matrices must have the same number of rows!" << std::endl;
+        return false;
+    }
+    const int num_resources = available.size();
+    for (const auto& row : allocation) {
+        if (row.size() != num_resources) {
+            std::cerr << "Allocation matrix rows must have the same number of columns!" << std::endl;
+            return false;
+        }
+    }
+    for (const auto& row : need) {
+        if (row.size() != num_resources) {
+            std::cerr << "Need matrix rows must have the same number of columns!" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+
+#endif // BANKER_HPP
\ No newline at end of file
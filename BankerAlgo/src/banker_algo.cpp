@@ -1,163 +1,228 @@
-#include "utils.hpp"
+#include "banker.hpp"
+#include "daemon.hpp"
+#include "whatif.hpp"
+#include "detect.hpp"
+#include "state_io.hpp"
 #include <iostream>
 #include <vector>
-#include <queue>
-#include <mutex>
-
-#ifdef DEBUG
-std::mutex mutex_debug;
-#define DEBUG_PRINT(x) \
-    do { std::lock_guard<std::mutex> lk(mutex_debug); std::cout << x << std::endl; } while(0)
-#else
-#define DEBUG_PRINT(x) do {} while(0)
-#endif
-
-
-enum class result {
-    FAIL    = 0,
-    WAIT    = 1,
-    SUCCESS = 2
-};
-
-bool is_safe(
-    const std::vector<int> available,
-    const std::vector<std::vector<int>> allocation,
-    const std::vector<std::vector<int>> need
-) {
-    DEBUG_PRINT("Checking if the system is in a safe state...");
-
-    std::vector<int> work = available;
-    std::queue<std::pair<int, int>> unfinished;
-    for (std::size_t i = 0; i < allocation.size(); ++i) {
-        unfinished.push(std::make_pair(i, 0));
-    }
-    DEBUG_PRINT("\tAllocation: " << allocation);
-    DEBUG_PRINT("\tNeed      : " << need);
-    DEBUG_PRINT("\tWork      : " << available);
-
-    int task_count = 0;
-    while (!unfinished.empty()) {
-        int id = unfinished.front().first;
-        int count = unfinished.front().second;
-        if (task_count < count) {
-            DEBUG_PRINT("System is not in a safe state.");
-            DEBUG_PRINT("\tRemaining : " << unfinished);
+#include <string>
+#include <sstream>
+#include <fstream>
+
+
+// 状态参数：--state <file> 或 <Available> <Allocation> <Need>，返回占用的参数个数
+int state_arg_count(int argc, char *argv[], int first) {
+    return first < argc && std::string(argv[first]) == "--state" ? 2 : 3;
+}
+
+// 从 argv[first] 起读取状态，失败时打印原因并返回 false
+bool read_state(char *argv[], int first, ResourceVector& available, ResourceMatrix& allocation, ResourceMatrix& need) {
+    if (std::string(argv[first]) == "--state") {
+        try {
+            ScopedTimer timer(banker_metrics.parse_ns);
+            load_state(argv[first + 1], available, allocation, need);
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+            std::cerr << "Input validation failed!" << std::endl;
             return false;
         }
-        unfinished.pop();
-
-        if (need[id] <= work) {
-            work += allocation[id];
-            ++task_count;
-            DEBUG_PRINT("\t\tTask " << id << " finished, work updated. \tTag: " << count << ",\ttasks finished: " << task_count);
-            DEBUG_PRINT("\tWork      : " << work);
-        } else {
-            unfinished.push(std::make_pair(id, task_count + 1));
-            DEBUG_PRINT("\t\tTask " << id << " cannot finish, skipped. \tTag: " << task_count + 1 << ",\ttasks finished: " << task_count);
-        }
+        return true;
+    }
+    auto start = metrics_clock::now();
+    std::vector<int> available_in = parseVector(argv[first]);
+    std::vector<std::vector<int>> allocation_in = parseMatrix(argv[first + 1]);
+    std::vector<std::vector<int>> need_in = parseMatrix(argv[first + 2]);
+    banker_metrics.add(banker_metrics.parse_ns, elapsed_ns(start));
+
+    start = metrics_clock::now();
+    const bool valid = check_state(available_in, allocation_in, need_in);
+    banker_metrics.add(banker_metrics.validation_ns, elapsed_ns(start));
+    if (!valid) {
+        std::cerr << "Input validation failed!" << std::endl;
+        return false;
     }
 
-    DEBUG_PRINT("System is in a safe state.");
+    // 转换为连续矩阵计入解析时间
+    ScopedTimer timer(banker_metrics.parse_ns);
+    const std::size_t num_resources = available_in.size();
+    available = ResourceVector(available_in);
+    allocation = ResourceMatrix(allocation_in, num_resources);
+    need = ResourceMatrix(need_in, num_resources);
     return true;
 }
 
+// 取出并删除 argv 中的 "name value" 选项，不存在时返回空串
+std::string take_option(int& argc, char *argv[], const std::string& name) {
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (name != argv[i]) continue;
+        std::string value = argv[i + 1];
+        for (int k = i; k + 2 < argc; ++k) argv[k] = argv[k + 2];
+        argc -= 2;
+        return value;
+    }
+    return "";
+}
 
-result banker_allocate(
-    std::vector<int>& available,
-    std::vector<std::vector<int>>& allocation,
-    std::vector<std::vector<int>>& need,
-    const std::vector<int>& request,
-    int request_id
-) {
-    if (request.empty()) {
-        DEBUG_PRINT("No resources requested.");
-        return result::SUCCESS;
+
+int run_daemon(int argc, char *argv[], const std::string& checkpoint, const std::string& interval) {
+    const int k = 2 + state_arg_count(argc, argv, 2);
+    if (argc < k) {
+        std::cerr << "Usage: " << argv[0] << " --daemon <Available> <Allocation> <Need> [socket_path] [--checkpoint file [--checkpoint-interval ms]]" << std::endl;
+        return 1;
     }
-    if (!(request <= need[request_id])) {
-        DEBUG_PRINT("Request exceeds need.");
-        return result::FAIL;
+    ResourceVector available;
+    ResourceMatrix allocation, need;
+    if (!read_state(argv, 2, available, allocation, need)) {
+        return 1;
     }
-    if (!(request <= available)) {
-        DEBUG_PRINT("Request exceeds available resources.");
-        return result::WAIT;
+
+    BankerDaemon daemon(std::move(available), std::move(allocation), std::move(need));
+    if (!checkpoint.empty()) {
+        daemon.set_checkpoint(checkpoint, interval.empty() ? 1000 : std::stoi(interval));
     }
+    if (argc > k) {
+        return daemon.run_socket(argv[k]);
+    }
+    return daemon.run_stdio();
+}
 
-    available -= request;
-    allocation[request_id] += request;
-    need[request_id] -= request;
 
-    if (!is_safe(available, allocation, need)) {
-        available += request;
-        allocation[request_id] -= request;
-        need[request_id] += request;
-        DEBUG_PRINT("Request cannot be granted, system is not in a safe state.");
-        return result::WAIT;
+int run_whatif(int argc, char *argv[]) {
+    const int k = 2 + state_arg_count(argc, argv, 2);
+    if (argc < k + 2) {
+        std::cerr << "Usage: " << argv[0] << " --whatif <Available> <Allocation> <Need> <Requests> <Ids> [threads]" << std::endl;
+        return 1;
+    }
+    ResourceVector available;
+    ResourceMatrix allocation, need;
+    if (!read_state(argv, 2, available, allocation, need)) {
+        return 1;
     }
+    std::vector<std::vector<int>> requests_in = parseMatrix(argv[k]);
+    std::vector<int> ids = parseVector(argv[k + 1]);
+    const std::size_t threads = argc > k + 2 ? std::stoul(argv[k + 2]) : std::thread::hardware_concurrency();
 
-    DEBUG_PRINT("Request granted.");
-    return result::SUCCESS;
+    if (requests_in.size() != ids.size()) {
+        std::cerr << "Number of requests must match the number of IDs!" << std::endl;
+        return 1;
+    }
+
+    std::vector<Candidate> candidates;
+    for (std::size_t k = 0; k < ids.size(); ++k) {
+        candidates.push_back(Candidate{ids[k], ResourceVector(requests_in[k])});
+    }
+
+    WhatIfEvaluator evaluator(threads);
+    std::vector<result> results = evaluator.evaluate(available, allocation, need, candidates);
+    for (std::size_t k = 0; k < results.size(); ++k) {
+        std::cout << "Candidate " << k << " (process " << ids[k] << "): " << result_name(results[k]) << std::endl;
+    }
+    return 0;
 }
 
 
-bool check_input(
-    const std::vector<int>& available,
-    const std::vector<std::vector<int>>& allocation,
-    const std::vector<std::vector<int>>& need,
-    const std::vector<int>& request,
-    int request_id
-) {
-    if (allocation.size() != need.size()) {
-        std::cerr << "Allocation and Need matrices must have the same number of rows!" << std::endl;
-        return false;
+int run_detect(int argc, char *argv[]) {
+    const int k = 2 + state_arg_count(argc, argv, 2);
+    if (argc < k) {
+        std::cerr << "Usage: " << argv[0] << " --detect <Available> <Allocation> <Request> [period]" << std::endl;
+        return 1;
     }
-    const int num_resources = available.size();
-    if (request.size() != num_resources) {
-        std::cerr << "Request vector size must match the number of resources!" << std::endl;
-        return false;
+    ResourceVector available;
+    ResourceMatrix allocation, request;
+    if (!read_state(argv, 2, available, allocation, request)) {
+        return 1;
     }
-    for (const auto& row : allocation) {
-        if (row.size() != num_resources) {
-            std::cerr << "Allocation matrix rows must have the same number of columns!" << std::endl;
-            return false;
-        }
+    const long period = argc > k ? std::stol(argv[k]) : 0;
+
+    DeadlockDetector detector(std::move(available), std::move(allocation), std::move(request));
+    std::cout << "Deadlocked: " << detector.detect() << std::endl;
+    if (period <= 0) {
+        return 0;
     }
-    for (const auto& row : need) {
-        if (row.size() != num_resources) {
-            std::cerr << "Need matrix rows must have the same number of columns!" << std::endl;
-            return false;
+
+    // 周期检测：从标准输入读取状态变化，每 period 次变化或遇到 detect 命令时检测一次
+    //   grant <id> <vec> | release <id> <vec> | request <id> <vec> | detect
+    std::string line;
+    long changes = 0;
+    while (std::getline(std::cin, line)) {
+        std::istringstream in(line);
+        std::string cmd, vec;
+        int id = -1;
+        if (!(in >> cmd)) continue;
+        if (cmd == "detect") {
+            std::cout << "Deadlocked: " << detector.detect() << std::endl;
+            changes = 0;
+            continue;
+        }
+        bool ok = false;
+        if (in >> id >> vec) {
+            ResourceVector v(parseVector(vec));
+            if (cmd == "grant") {
+                ok = detector.grant(id, v);
+            } else if (cmd == "release") {
+                ok = detector.release(id, v);
+            } else if (cmd == "request") {
+                ok = detector.set_request(id, v);
+            }
+        }
+        if (!ok) {
+            std::cerr << "Invalid change: " << line << std::endl;
+            continue;
+        }
+        if (++changes == period) {
+            std::cout << "Deadlocked: " << detector.detect() << std::endl;
+            changes = 0;
         }
     }
-    if (request_id < 0 || request_id >= allocation.size()) {
-        std::cerr << "Request ID is out of range!" << std::endl;
-        return false;
-    }
-    return true;
+    DEBUG_PRINT("Detection runs: " << detector.stats().full_runs << " full, " << detector.stats().incremental_runs
+                << " incremental, " << detector.stats().skipped << " skipped");
+    return 0;
 }
 
 
-int main(int argc, char *argv[]) {
-    DEBUG_PRINT("Banker Algorithm Simulation");
-    if (argc < 6) {
-        std::cerr << "Usage: " << argv[0] << " <Available> <Allocation> <Need> <Request> <Id>" << std::endl;
+int run_allocate(int argc, char *argv[], const std::string& checkpoint) {
+    const int k = 1 + state_arg_count(argc, argv, 1);
+    if (argc < k + 2) {
+        std::cerr << "Usage: " << argv[0] << " <Available> <Allocation> <Need> <Request> <Id> [--checkpoint file]" << std::endl;
+        std::cerr << "       " << argv[0] << " --daemon <Available> <Allocation> <Need> [socket_path] [--checkpoint file [--checkpoint-interval ms]]" << std::endl;
+        std::cerr << "       " << argv[0] << " --whatif <Available> <Allocation> <Need> <Requests> <Ids> [threads]" << std::endl;
+        std::cerr << "       " << argv[0] << " --detect <Available> <Allocation> <Request> [period]" << std::endl;
+        std::cerr << "<Available> <Allocation> <Need> may be replaced by --state <file> (text or binary snapshot)" << std::endl;
+        std::cerr << "--stats-json <file|-> writes counters and timers as JSON on exit" << std::endl;
+        return 1;
+    }
+    ResourceVector available;
+    ResourceMatrix allocation, need;
+    if (!read_state(argv, 1, available, allocation, need)) {
         return 1;
     }
-    std::vector<int> available = parseVector(argv[1]);
-    std::vector<std::vector<int>> allocation = parseMatrix(argv[2]);
-    std::vector<std::vector<int>> need = parseMatrix(argv[3]);
-    std::vector<int> request = parseVector(argv[4]);
-    int request_id = std::stoi(argv[5]);
+    auto start = metrics_clock::now();
+    std::vector<int> request_in = parseVector(argv[k]);
+    int request_id = std::stoi(argv[k + 1]);
+    banker_metrics.add(banker_metrics.parse_ns, elapsed_ns(start));
 
     DEBUG_PRINT("Requesting resources...");
     DEBUG_PRINT("\tAvailable : " << available);
     DEBUG_PRINT("\tAllocation: " << allocation);
     DEBUG_PRINT("\tNeed      : " << need);
-    DEBUG_PRINT("\tRequest   : " << request);
+    DEBUG_PRINT("\tRequest   : " << request_in);
     DEBUG_PRINT("\tRequest ID: " << request_id);
 
-    if (!check_input(available, allocation, need, request, request_id)) {
+    start = metrics_clock::now();
+    const bool size_ok = request_in.size() == available.size();
+    const bool id_ok = request_id >= 0 && request_id < static_cast<int>(allocation.rows());
+    banker_metrics.add(banker_metrics.validation_ns, elapsed_ns(start));
+    if (!size_ok) {
+        std::cerr << "Request vector size must match the number of resources!" << std::endl;
+        std::cerr << "Input validation failed!" << std::endl;
+        return 1;
+    }
+    if (!id_ok) {
+        std::cerr << "Request ID is out of range!" << std::endl;
         std::cerr << "Input validation failed!" << std::endl;
         return 1;
     }
+    ResourceVector request(request_in);
 
     result res = banker_allocate(available, allocation, need, request, request_id);
 
@@ -167,18 +232,49 @@ int main(int argc, char *argv[]) {
     DEBUG_PRINT("\tAllocation: " << allocation);
     DEBUG_PRINT("\tNeed      : " << need);
 
-    std::cout << "Result: ";
-    switch (res) {
-        case result::FAIL:
-            std::cout << "FAIL" << std::endl;
-            break;
-        case result::WAIT:
-            std::cout << "WAIT" << std::endl;
-            break;
-        case result::SUCCESS:
-            std::cout << "SUCCESS" << std::endl;
-            break;
+    std::cout << "Result: " << result_name(res) << std::endl;
+
+    if (!checkpoint.empty()) {
+        try {
+            save_snapshot(checkpoint, available, allocation, need);
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+        DEBUG_PRINT("State saved to " << checkpoint);
     }
 
     return 0;
-}
\ No newline at end of file
+}
+
+
+int main(int argc, char *argv[]) {
+    DEBUG_PRINT("Banker Algorithm Simulation");
+    const std::string checkpoint = take_option(argc, argv, "--checkpoint");
+    const std::string checkpoint_interval = take_option(argc, argv, "--checkpoint-interval");
+    const std::string stats_json = take_option(argc, argv, "--stats-json");
+    int ret;
+    if (argc > 1 && std::string(argv[1]) == "--daemon") {
+        ret = run_daemon(argc, argv, checkpoint, checkpoint_interval);
+    } else if (argc > 1 && std::string(argv[1]) == "--whatif") {
+        ret = run_whatif(argc, argv);
+    } else if (argc > 1 && std::string(argv[1]) == "--detect") {
+        ret = run_detect(argc, argv);
+    } else {
+        ret = run_allocate(argc, argv, checkpoint);
+    }
+
+    if (stats_json == "-") {
+        banker_metrics.write_json(std::cout);
+        std::cout << std::endl;
+    } else if (!stats_json.empty()) {
+        std::ofstream out(stats_json);
+        banker_metrics.write_json(out);
+        out << '\n';
+        if (!out) {
+            std::cerr << "Failed to write " << stats_json << std::endl;
+            return 1;
+        }
+    }
+    return ret;
+}
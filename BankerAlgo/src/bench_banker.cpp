@@ -0,0 +1,86 @@
+#include "banker.hpp"
+#include "generator.hpp"
+#include "metrics.hpp"
+#include <iostream>
+#include <vector>
+#include <random>
+#include <algorithm>
+
+
+// 对逐步增大的生成状态反复调用 banker_allocate，按决策结果分别报告单次决策的延迟分位数。
+// 生成的安全状态没有余量：每次请求只在随机三类资源上取 need 行的一小部分，
+// 一部分试分配后仍安全（SUCCESS，规约要经过等待堆才完成），多数不安全而 WAIT 并回滚；
+// 约每 16 次有一次超出 need 而直接 FAIL。
+// 授予后立即归还，使状态在整轮测试中保持不变，不同规模之间的结果可以直接比较。
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <max_processes> [resources] [requests] [seed]" << std::endl;
+        return 1;
+    }
+    const std::size_t max_n = std::stoul(argv[1]);
+    const std::size_t m = argc > 2 ? std::stoul(argv[2]) : 64;
+    const std::size_t requests = argc > 3 ? std::stoul(argv[3]) : 1000;
+    const unsigned seed = argc > 4 ? std::stoul(argv[4]) : 2025;
+    if (requests == 0) {
+        std::cerr << "Number of requests must be positive!" << std::endl;
+        return 1;
+    }
+    std::vector<std::size_t> sizes;
+    for (std::size_t n = 100; n < max_n; n *= 10) sizes.push_back(n);
+    sizes.push_back(max_n);
+
+    bool ok = true;
+    std::vector<std::uint64_t> latency[3];   // 下标为 result 的值：FAIL, WAIT, SUCCESS
+    for (std::size_t n : sizes) {
+        GeneratedState s = generate_state(n, m, state_kind::SAFE, seed);
+        const ResourceVector initial = s.available;
+        std::mt19937 gen(seed + n);
+        ResourceVector request(m);
+        banker_metrics.reset();
+        for (auto& l : latency) l.clear();
+
+        for (std::size_t r = 0; r < requests; ++r) {
+            const int id = gen() % n;
+            for (std::size_t j = 0; j < m; ++j) request[j] = 0;
+            for (int k = 0; k < 3; ++k) {
+                const std::size_t j = gen() % m;
+                const int limit = std::min({s.need(id, j), s.available[j], 2});
+                request[j] = limit > 0 ? gen() % (limit + 1) : 0;
+            }
+            if (gen() % 16 == 0) {
+                const std::size_t j = gen() % m;
+                request[j] = s.need(id, j) + 1;
+            }
+            const auto start = metrics_clock::now();
+            result res = banker_allocate(s.available, s.allocation, s.need, request, id);
+            latency[static_cast<int>(res)].push_back(elapsed_ns(start));
+            if (res == result::SUCCESS) {
+                ok &= banker_release(s.available, s.allocation, s.need, request, id);
+            }
+        }
+        ok &= initial.to_vector() == s.available.to_vector();
+
+        const MetricsTotals totals = banker_metrics.totals();
+        const std::uint64_t checks = totals.safety_checks;
+        std::cout << n << "x" << m;
+        const char* names[] = {"fail", "wait", "success"};
+        for (int k : {2, 1, 0}) {
+            std::vector<std::uint64_t>& l = latency[k];
+            std::cout << "\t" << names[k] << " " << l.size();
+            if (l.empty()) continue;
+            std::sort(l.begin(), l.end());
+            auto pct = [&](double p) { return l[std::min(l.size() - 1, static_cast<std::size_t>(p * l.size()))] / 1e3; };
+            std::cout << " (p50 " << pct(0.50) << " / p90 " << pct(0.90) << " / p99 " << pct(0.99)
+                      << " / max " << l.back() / 1e3 << " us)";
+        }
+        std::cout << "\titerations/check: " << (checks ? totals.iterations / checks : 0) << "\t";
+        banker_metrics.write_json(std::cout);
+        std::cout << std::endl;
+    }
+
+    if (!ok) {
+        std::cerr << "State changed after releasing every granted request!" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,110 @@
+#include "detect.hpp"
+#include "generator.hpp"
+#include <iostream>
+#include <vector>
+#include <random>
+#include <chrono>
+
+
+template <typename F>
+double time_ms(F&& f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+
+int main(int argc, char *argv[]) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " <processes> <resources> [updates] [seed]" << std::endl;
+        return 1;
+    }
+    const std::size_t n = std::stoul(argv[1]);
+    const std::size_t m = std::stoul(argv[2]);
+    const int updates = argc > 3 ? std::stoi(argv[3]) : 100;
+    const unsigned seed = argc > 4 ? std::stoul(argv[4]) : 2025;
+    bool mismatch = false;
+
+    // 避免：安全性检查
+    SafetyChecker checker;
+    for (state_kind kind : {state_kind::SAFE, state_kind::UNSAFE}) {
+        const GeneratedState s = generate_state(n, m, kind, seed);
+        bool safe = false;
+        double t = time_ms([&] { safe = checker.is_safe(s.available, s.allocation, s.need); });
+        mismatch |= safe != (kind == state_kind::SAFE);
+        std::cout << n << "x" << m << (kind == state_kind::SAFE ? "\tsafe    " : "\tunsafe  ")
+                  << "\tis_safe: " << t << " ms (" << (safe ? "safe" : "unsafe") << ")" << std::endl;
+    }
+
+    // 检测：完整规约
+    const GeneratedState s = generate_state(n, m, state_kind::DEADLOCK, seed);
+    DeadlockDetector detector(s.available, s.allocation, s.need);
+    std::vector<int> deadlocked;
+    double t_full = time_ms([&] { deadlocked = detector.detect(); });
+    mismatch |= deadlocked != s.stuck;
+    std::cout << n << "x" << m << "\tdeadlock"
+              << "\tdetect: " << t_full << " ms (" << deadlocked.size() << " deadlocked, "
+              << s.stuck.size() << " expected)" << std::endl;
+
+    // 检测：随机施加各类状态变化，每次变化后增量检测，并与从头检测的结果对照：
+    //   0 随机进程归还一个单位的资源     1 死锁进程把某一类请求减半
+    //   2 任意进程的请求改为随机向量（可能与原请求不可比）
+    //   3 死锁进程的请求改为随机向量     4 授予某进程部分请求
+    std::mt19937 gen(seed);
+    ResourceVector delta(m);
+    double t_incremental = 0, t_scratch = 0;
+    for (int u = 0; u < updates; ++u) {
+        const ResourceVector& available = detector.available_vector();
+        const ResourceMatrix& allocation = detector.allocation_matrix();
+        const ResourceMatrix& request = detector.request_matrix();
+        const std::size_t j = gen() % m;
+        int id = gen() % n;
+        int kind = u % 5;
+        if ((kind == 1 || kind == 3) && deadlocked.empty()) kind = 2;
+        if (kind == 1 || kind == 3) id = deadlocked[gen() % deadlocked.size()];
+        switch (kind) {
+            case 0:
+                for (std::size_t k = 0; k < m; ++k) delta[k] = 0;
+                delta[j] = allocation(id, j) > 0 ? 1 : 0;
+                detector.release(id, delta);
+                break;
+            case 1:
+                for (std::size_t k = 0; k < m; ++k) delta[k] = request(id, k);
+                delta[j] /= 2;
+                detector.set_request(id, delta);
+                break;
+            case 2:
+            case 3:
+                for (std::size_t k = 0; k < m; ++k) delta[k] = gen() % (request(id, k) + 3);
+                detector.set_request(id, delta);
+                break;
+            default:
+                for (std::size_t k = 0; k < m; ++k) {
+                    const int limit = std::min(request(id, k), available[k]);
+                    delta[k] = limit > 0 ? gen() % (limit + 1) : 0;
+                }
+                detector.grant(id, delta);
+                break;
+        }
+        t_incremental += time_ms([&] { deadlocked = detector.detect(); });
+
+        DeadlockDetector scratch(available, allocation, request);
+        std::vector<int> expected;
+        t_scratch += time_ms([&] { expected = scratch.detect(); });
+        mismatch |= deadlocked != expected;
+    }
+    const DetectorStats& stats = detector.stats();
+    std::cout << n << "x" << m << "\tupdates " << updates
+              << "\tincremental: " << t_incremental << " ms (" << stats.full_runs << " full, "
+              << stats.incremental_runs << " incremental, "
+              << stats.skipped << " skipped)"
+              << "\tfrom scratch: " << t_scratch << " ms"
+              << "\tremaining deadlocked: " << deadlocked.size() << std::endl;
+
+    if (mismatch) {
+        std::cerr << "Detection results differ from the expected ones!" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,102 @@
+#include "banker.hpp"
+#include "generator.hpp"
+#include <iostream>
+#include <vector>
+#include <random>
+#include <chrono>
+
+
+enum class workload {
+    SHUFFLED,  // 随机安全序列，由 generate_state 生成
+    CHAIN      // 每一步恰有一个进程可完成，且排在队列中上一个完成进程之前
+};
+
+// 构造 CHAIN 安全状态：按进程号倒序依次完成时恰好不缺资源。
+// 循环队列实现每完成一个进程都要绕队列一整圈，即其 O(n^2 m) 的最坏情况。
+void make_chain_state(
+    std::size_t n, std::size_t m, unsigned seed,
+    std::vector<int>& available,
+    std::vector<std::vector<int>>& allocation,
+    std::vector<std::vector<int>>& need
+) {
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<int> dist_alloc(0, 3);
+    allocation.assign(n, std::vector<int>(m));
+    need.assign(n, std::vector<int>(m));
+    available.assign(m, 0);
+    std::vector<int> freed(m, 0);
+    for (std::size_t k = n; k-- > 0;) {
+        for (std::size_t j = 0; j < m; ++j) {
+            need[k][j] = freed[j];
+            allocation[k][j] = 1 + dist_alloc(gen);
+            freed[j] += allocation[k][j];
+        }
+    }
+}
+
+template <typename F>
+double time_ms(F&& f, int rounds, bool& out) {
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; ++r) out = f();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count() / rounds;
+}
+
+
+int main(int argc, char *argv[]) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " <processes> <resources> [rounds] [seed]" << std::endl;
+        return 1;
+    }
+    const std::size_t n = std::stoul(argv[1]);
+    const std::size_t m = std::stoul(argv[2]);
+    const int rounds = argc > 3 ? std::stoi(argv[3]) : 3;
+    const unsigned seed = argc > 4 ? std::stoul(argv[4]) : 2025;
+
+    std::vector<int> available;
+    std::vector<std::vector<int>> allocation, need;
+    SafetyChecker checker;
+    bool mismatch = false;
+
+    for (int variant = 0; variant < 4; ++variant) {
+        const workload kind = variant & 1 ? workload::CHAIN : workload::SHUFFLED;
+        const bool unsafe = variant & 2;
+        if (kind == workload::CHAIN) {
+            make_chain_state(n, m, seed + variant, available, allocation, need);
+        } else {
+            const GeneratedState s = generate_state(n, m, state_kind::SAFE, seed + variant);
+            available = s.available.to_vector();
+            allocation = s.allocation.to_nested();
+            need = s.need.to_nested();
+        }
+        if (unsafe) {
+            // 收紧一类资源，使安全序列在某一步缺少一个单位
+            for (std::size_t j = 0; j < m; ++j) {
+                if (available[j] > 0) {
+                    --available[j];
+                    break;
+                }
+            }
+            if (kind == workload::CHAIN) ++need[n - 1][0];
+        }
+
+        bool safe_queue = false, safe_indexed = false;
+        double t_queue = time_ms([&] { return is_safe_queue(available, allocation, need); }, rounds, safe_queue);
+        const ResourceVector flat_available(available);
+        const ResourceMatrix flat_allocation(allocation, m), flat_need(need, m);
+        double t_indexed = time_ms([&] { return checker.is_safe(flat_available, flat_allocation, flat_need); }, rounds, safe_indexed);
+        mismatch |= safe_queue != safe_indexed;
+
+        std::cout << n << "x" << m
+                  << (kind == workload::CHAIN ? "\tchain   " : "\tshuffled")
+                  << "\tqueue: " << t_queue << " ms (" << (safe_queue ? "safe" : "unsafe") << ")"
+                  << "\tindexed: " << t_indexed << " ms (" << (safe_indexed ? "safe" : "unsafe") << ")"
+                  << "\tspeedup: " << t_queue / t_indexed << "x" << std::endl;
+    }
+
+    if (mismatch) {
+        std::cerr << "Results of is_safe_queue and SafetyChecker differ!" << std::endl;
+        return 1;
+    }
+    return 0;
+}
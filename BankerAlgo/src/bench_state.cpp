@@ -0,0 +1,84 @@
+#include "banker.hpp"
+#include "generator.hpp"
+#include "state_io.hpp"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <chrono>
+#include <cstdio>
+
+
+template <typename F>
+double time_ms(F&& f, int rounds) {
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; ++r) f();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count() / rounds;
+}
+
+bool same_state(const ResourceVector& a0, const ResourceMatrix& a1, const ResourceMatrix& a2,
+                const ResourceVector& b0, const ResourceMatrix& b1, const ResourceMatrix& b2) {
+    if (a0.to_vector() != b0.to_vector() || a1.rows() != b1.rows() || a2.rows() != b2.rows()) return false;
+    return a1.to_nested() == b1.to_nested() && a2.to_nested() == b2.to_nested();
+}
+
+
+int main(int argc, char *argv[]) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " <processes> <resources> [rounds] [dir]" << std::endl;
+        return 1;
+    }
+    const std::size_t n = std::stoul(argv[1]);
+    const std::size_t m = std::stoul(argv[2]);
+    const int rounds = argc > 3 ? std::stoi(argv[3]) : 3;
+    const std::string dir = argc > 4 ? argv[4] : "/tmp";
+    const std::string text_path = dir + "/bench_state.txt";
+    const std::string snapshot_path = dir + "/bench_state.snap";
+
+    const GeneratedState s = generate_state(n, m, state_kind::SAFE, 2025);
+    std::string lines[3];
+    {
+        std::ostringstream os;
+        write_state(os, s);
+        std::istringstream is(os.str());
+        for (auto& line : lines) std::getline(is, line);
+        std::ofstream(text_path) << os.str();
+    }
+    double t_save = time_ms([&] { save_snapshot(snapshot_path, s.available, s.allocation, s.need); }, rounds);
+
+    ResourceVector available;
+    ResourceMatrix allocation, need;
+    bool ok = true;
+
+    // 命令行参数方式：stringstream + getline + stoi，再转换为连续矩阵
+    double t_argv = time_ms([&] {
+        std::vector<int> available_in = parseVector(lines[0]);
+        std::vector<std::vector<int>> allocation_in = parseMatrix(lines[1]);
+        std::vector<std::vector<int>> need_in = parseMatrix(lines[2]);
+        available = ResourceVector(available_in);
+        allocation = ResourceMatrix(allocation_in, m);
+        need = ResourceMatrix(need_in, m);
+    }, rounds);
+    ok &= same_state(available, allocation, need, s.available, s.allocation, s.need);
+
+    double t_text = time_ms([&] { load_state(text_path, available, allocation, need); }, rounds);
+    ok &= same_state(available, allocation, need, s.available, s.allocation, s.need);
+
+    double t_snapshot = time_ms([&] { load_state(snapshot_path, available, allocation, need); }, rounds);
+    ok &= same_state(available, allocation, need, s.available, s.allocation, s.need);
+
+    std::cout << n << "x" << m
+              << "\targv parse: " << t_argv << " ms"
+              << "\tmmap text: " << t_text << " ms"
+              << "\tsnapshot load: " << t_snapshot << " ms"
+              << "\tsnapshot save: " << t_save << " ms" << std::endl;
+
+    std::remove(text_path.c_str());
+    std::remove(snapshot_path.c_str());
+    if (!ok) {
+        std::cerr << "Loaded state differs from the generated one!" << std::endl;
+        return 1;
+    }
+    return 0;
+}
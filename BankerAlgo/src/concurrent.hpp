@@ -0,0 +1,300 @@
+#ifndef CONCURRENT_HPP
+#define CONCURRENT_HPP
+
+#include "banker.hpp"
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+// 线程安全的银行家分配器。
+//
+// 各线程的请求与释放先放入共享队列；队列非空且无人处理时，提交者自己成为合并者（flat combining），
+// 一次取走整个队列作为一批在锁外处理，处理期间其他线程只需入队等待。每批内：
+//   1. 先执行全部释放；若有资源归还，此前被 WAIT 挂起的阻塞请求加入本批重试；
+//   2. 把所有不超过 need 与当前 available 的请求一起试分配，只做一次安全性检查；
+//      安全则整批授予，不安全则全部回滚并逐个按 banker_allocate 的规则检查。
+// request() 在 WAIT 时挂起直到被授予或失败；try_request() 立即返回 WAIT；
+// try_requests() 把多个非阻塞请求一次入队，保证它们在同一批中处理。
+// 状态只由当前合并者访问，队列与完成标志由 mutex 保护。
+
+
+struct ConcurrentStats {
+    std::size_t operations = 0;     // 已处理的请求、释放次数（含重试）
+    std::size_t batches = 0;        // 批次数
+    std::size_t safety_checks = 0;  // 安全性检查次数
+    std::size_t fallbacks = 0;      // 整批不安全而逐个检查的批次数
+};
+
+
+class ConcurrentBanker {
+public:
+    ConcurrentBanker(ResourceVector available, ResourceMatrix allocation, ResourceMatrix need)
+        : available(std::move(available)),
+          allocation(std::move(allocation)),
+          need(std::move(need)) {}
+
+    // 阻塞请求：返回 SUCCESS 或 FAIL
+    result request(int id, const ResourceVector& request) {
+        if (!valid(id, request)) return result::FAIL;
+        Op op{op_kind::REQUEST, id, &request};
+        return submit(op);
+    }
+
+    // 非阻塞请求：返回 SUCCESS、FAIL 或 WAIT
+    result try_request(int id, const ResourceVector& request) {
+        if (!valid(id, request)) return result::FAIL;
+        Op op{op_kind::TRY_REQUEST, id, &request};
+        return submit(op);
+    }
+
+    // 把多个非阻塞请求一次放入队列，保证它们落在同一批中处理，按顺序返回各自的结果
+    std::vector<result> try_requests(const std::vector<int>& ids, const std::vector<ResourceVector>& requests) {
+        std::vector<Op> ops;
+        ops.reserve(ids.size());
+        for (std::size_t k = 0; k < ids.size(); ++k) {
+            ops.push_back(Op{op_kind::TRY_REQUEST, ids[k], &requests[k]});
+            if (!valid(ids[k], requests[k])) {
+                ops.back().res = result::FAIL;
+                ops.back().done = true;
+            }
+        }
+        std::vector<Op*> pending;
+        for (Op& op : ops) {
+            if (!op.done) pending.push_back(&op);
+        }
+        if (!pending.empty()) submit(pending.data(), pending.size());
+        std::vector<result> results;
+        for (const Op& op : ops) results.push_back(op.res);
+        return results;
+    }
+
+    bool release(int id, const ResourceVector& release) {
+        if (!valid(id, release)) return false;
+        Op op{op_kind::RELEASE, id, &release};
+        return submit(op) == result::SUCCESS;
+    }
+
+    // 取得一致的状态快照，反映提交时所在批次处理完毕后的状态
+    void snapshot(ResourceVector& available_out, ResourceMatrix& allocation_out, ResourceMatrix& need_out) {
+        Op op{op_kind::SNAPSHOT};
+        op.available_out = &available_out;
+        op.allocation_out = &allocation_out;
+        op.need_out = &need_out;
+        submit(op);
+    }
+
+    ConcurrentStats stats() const {
+        std::lock_guard<std::mutex> lk(mutex);
+        return counters;
+    }
+
+private:
+    enum class op_kind { REQUEST, TRY_REQUEST, RELEASE, SNAPSHOT };
+
+    struct Op {
+        op_kind kind;
+        int id = 0;
+        const ResourceVector* vec = nullptr;
+        result res = result::WAIT;
+        bool done = false;
+        ResourceVector* available_out = nullptr;
+        ResourceMatrix* allocation_out = nullptr;
+        ResourceMatrix* need_out = nullptr;
+    };
+
+    mutable std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<Op*> queue;
+    bool combining = false;
+    ConcurrentStats counters;
+
+    // 以下成员只由合并者访问
+    ResourceVector available;
+    ResourceMatrix allocation;
+    ResourceMatrix need;
+    SafetyChecker checker;
+    std::vector<Op*> batch;
+    std::vector<Op*> requests;
+    std::vector<Op*> candidates;  // 非空请求，按提交顺序
+    std::vector<Op*> tentative;   // 已试分配的请求，为 candidates 的子序列
+    std::vector<Op*> exceeded;    // 超过（试分配后的）need 的请求，为 candidates 的子序列
+    std::vector<Op*> parked;     // 被 WAIT 的阻塞请求，待有资源归还时重试
+    std::vector<Op*> completed;
+    ConcurrentStats batch_counters;
+
+    // 负分量会让 release 变成不经检查的申请、request 变成归还
+    bool valid(int id, const ResourceVector& vec) const {
+        return id >= 0 && id < static_cast<int>(allocation.rows()) && vec.size() == available.size()
+            && vec_nonneg(vec.data(), vec.stride());
+    }
+
+    result submit(Op& op) {
+        Op* ops[] = {&op};
+        submit(ops, 1);
+        return op.res;
+    }
+
+    // 一次性入队 count 个操作，直到全部完成才返回
+    void submit(Op* const* ops, std::size_t count) {
+        std::unique_lock<std::mutex> lk(mutex);
+        queue.insert(queue.end(), ops, ops + count);
+        auto all_done = [&] {
+            for (std::size_t k = 0; k < count; ++k) {
+                if (!ops[k]->done) return false;
+            }
+            return true;
+        };
+        while (!all_done()) {
+            // 已有合并者，或自己的请求已被挂起且队列为空：等待他人处理
+            if (combining || queue.empty()) {
+                cv.wait(lk);
+                continue;
+            }
+            combining = true;
+            while (!queue.empty()) {
+                batch.swap(queue);
+                lk.unlock();
+                process_batch();
+                lk.lock();
+                for (Op* o : completed) o->done = true;
+                counters.operations += batch_counters.operations;
+                counters.batches += batch_counters.batches;
+                counters.safety_checks += batch_counters.safety_checks;
+                counters.fallbacks += batch_counters.fallbacks;
+                batch_counters = ConcurrentStats();
+                completed.clear();
+                batch.clear();
+                cv.notify_all();
+            }
+            combining = false;
+        }
+    }
+
+    void complete(Op* op, result res) {
+        op->res = res;
+        completed.push_back(op);
+    }
+
+    void process_batch() {
+        DEBUG_PRINT("Processing batch of " << batch.size() << " operation(s)");
+        ++batch_counters.batches;
+        const std::size_t stride = available.stride();
+        bool released = false;
+        requests.clear();
+
+        for (Op* op : batch) {
+            if (op->kind != op_kind::RELEASE) continue;
+            ++batch_counters.operations;
+            int* alloc_row = allocation.row(op->id);
+            if (!vec_le(op->vec->data(), alloc_row, stride)) {
+                complete(op, result::FAIL);
+                continue;
+            }
+            revert_request(available.data(), alloc_row, need.row(op->id), op->vec->data(), stride);
+            released = true;
+            complete(op, result::SUCCESS);
+        }
+        if (released) {
+            requests.swap(parked);
+        }
+        for (Op* op : batch) {
+            if (op->kind == op_kind::REQUEST || op->kind == op_kind::TRY_REQUEST) {
+                requests.push_back(op);
+            }
+        }
+        grant();
+
+        for (Op* op : batch) {
+            if (op->kind != op_kind::SNAPSHOT) continue;
+            *op->available_out = available;
+            *op->allocation_out = allocation;
+            *op->need_out = need;
+            complete(op, result::SUCCESS);
+        }
+    }
+
+    void grant() {
+        const std::size_t stride = available.stride();
+        candidates.clear();
+        tentative.clear();
+        exceeded.clear();
+        for (Op* op : requests) {
+            ++batch_counters.operations;
+            if (op->vec->empty()) {
+                complete(op, result::SUCCESS);
+                continue;
+            }
+            candidates.push_back(op);
+            if (!vec_le(op->vec->data(), need.row(op->id), stride)) {
+                // 可能只因同一进程更早的试分配降低了 need 才超出，整批回滚时须重新检查
+                exceeded.push_back(op);
+            } else if (vec_le(op->vec->data(), available.data(), stride)) {
+                apply_request(available.data(), allocation.row(op->id), need.row(op->id), op->vec->data(), stride);
+                tentative.push_back(op);
+            }
+        }
+
+        // 整批安全时，各请求所见的 need 与 available 与逐个处理时相同：
+        // 试分配的请求授予，超出 need 的失败，其余只可能因本批已授予的资源而不足，等待后续归还
+        bool safe = tentative.empty();
+        if (!safe) {
+            ++batch_counters.safety_checks;
+            safe = checker.is_safe(available, allocation, need);
+        }
+        if (safe) {
+            std::size_t t = 0, e = 0;
+            for (Op* op : candidates) {
+                if (t < tentative.size() && tentative[t] == op) {
+                    complete(op, result::SUCCESS);
+                    ++t;
+                } else if (e < exceeded.size() && exceeded[e] == op) {
+                    complete(op, result::FAIL);
+                    ++e;
+                } else {
+                    wait(op);
+                }
+            }
+            return;
+        }
+
+        // 整批不安全：全部回滚，再按提交顺序逐个检查所有请求（含先前因同批占用而不足或超出 need 的请求）
+        DEBUG_PRINT("Batch of " << tentative.size() << " request(s) is unsafe, checking one by one");
+        ++batch_counters.fallbacks;
+        for (auto it = tentative.rbegin(); it != tentative.rend(); ++it) {
+            Op* op = *it;
+            revert_request(available.data(), allocation.row(op->id), need.row(op->id), op->vec->data(), stride);
+        }
+        for (Op* op : candidates) {
+            if (!vec_le(op->vec->data(), need.row(op->id), stride)) {
+                complete(op, result::FAIL);
+                continue;
+            }
+            if (!vec_le(op->vec->data(), available.data(), stride)) {
+                wait(op);
+                continue;
+            }
+            int* alloc_row = allocation.row(op->id);
+            int* need_row = need.row(op->id);
+            apply_request(available.data(), alloc_row, need_row, op->vec->data(), stride);
+            ++batch_counters.safety_checks;
+            if (checker.is_safe(available, allocation, need)) {
+                complete(op, result::SUCCESS);
+            } else {
+                revert_request(available.data(), alloc_row, need_row, op->vec->data(), stride);
+                wait(op);
+            }
+        }
+    }
+
+    void wait(Op* op) {
+        if (op->kind == op_kind::TRY_REQUEST) {
+            complete(op, result::WAIT);
+        } else {
+            parked.push_back(op);
+        }
+    }
+};
+
+
+#endif // CONCURRENT_HPP
@@ -0,0 +1,546 @@
+#ifndef DAEMON_HPP
+#define DAEMON_HPP
+
+#include "banker.hpp"
+#include "whatif.hpp"
+#include "state_io.hpp"
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <list>
+#include <chrono>
+#include <csignal>
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+// 常驻模式：状态只解析一次，之后从 stdin 或 Unix 域套接字读取命令流，按批处理。
+//
+// 命令（每行一条）：
+//   request <id> <r1,r2,...>   -> SUCCESS | FAIL | WAIT <ticket>
+//   release <id> [r1,r2,...]   -> RELEASED | ERROR ...      （省略向量时释放该进程全部资源）
+//   query                      -> AVAILABLE [...] PENDING <n>
+//   query <id>                 -> PROCESS <id> ALLOCATION [...] NEED [...]
+//   whatif <id> <r1,...> [<id> <r1,...> ...]
+//                              -> WHATIF <SUCCESS|WAIT|FAIL> ...  （仅评估，不修改状态）
+//   checkpoint [path]          -> CHECKPOINT <path>              （把当前状态写成二进制快照）
+//   stats                      -> STATS {...}                    （banker_metrics 的 JSON）
+//   quit                       -> 关闭当前连接
+//   shutdown                   -> 处理完当前批次后退出
+// 被 WAIT 的请求在每批出现释放后自动重试，结果以 SUCCESS <ticket> 或 FAIL <ticket> 异步返回。
+// 设置了 set_checkpoint 时，若状态有变化（授予或释放），至多每 interval_ms 把状态写入该快照一次，
+// 退出前总会写入最后的状态；写快照要 fsync，大状态上远慢于一次决策，不能每批都写。
+// 重启时用 --state 直接加载即可恢复（异常退出时最多丢失最近 interval_ms 内的变化）；
+// 挂起的请求属于各自连接，不写入快照。
+//
+// 套接字连接设为非阻塞：回复先写入连接的 outbuf，写不完的部分留待 poll 报告 POLLOUT 后续写，
+// 不读回复的客户端不会阻塞其他连接；outbuf 积压超过 max_outbuf 时暂停读取该连接的命令。
+// stdio 模式只有一个连接，stdout 保持阻塞（O_NONBLOCK 会影响与父进程共享的文件描述）。
+
+
+volatile std::sig_atomic_t daemon_stop = 0;
+
+void daemon_signal_handler(int) {
+    daemon_stop = 1;
+}
+
+
+struct Session {
+    int in_fd;
+    int out_fd;
+    std::string inbuf;
+    std::string outbuf;
+    bool eof = false;
+    bool ended = false;     // 已 quit 或写出错，只待发送完剩余回复后关闭
+    bool closed = false;
+};
+
+struct Command {
+    std::size_t session;
+    std::string line;
+};
+
+struct PendingRequest {
+    std::size_t session;
+    long ticket;
+    int id;
+    ResourceVector request;
+};
+
+
+class BankerDaemon {
+public:
+    BankerDaemon(
+        ResourceVector available,
+        ResourceMatrix allocation,
+        ResourceMatrix need,
+        std::size_t max_batch = 1024
+    ) : available(std::move(available)),
+        allocation(std::move(allocation)),
+        need(std::move(need)),
+        max_batch(max_batch) {}
+
+    void set_checkpoint(const std::string& path, int interval_ms = 1000) {
+        checkpoint_path = path;
+        checkpoint_interval = std::chrono::milliseconds(interval_ms);
+    }
+
+    int run_stdio() {
+        sessions.push_back(Session{STDIN_FILENO, STDOUT_FILENO});
+        return serve(-1);
+    }
+
+    int run_socket(const std::string& path) {
+        int listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listen_fd < 0) {
+            std::cerr << "Failed to create socket: " << std::strerror(errno) << std::endl;
+            return 1;
+        }
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(addr.sun_path)) {
+            std::cerr << "Socket path is too long!" << std::endl;
+            close(listen_fd);
+            return 1;
+        }
+        std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+        unlink(path.c_str());
+        if (bind(listen_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || listen(listen_fd, 64) != 0) {
+            std::cerr << "Failed to listen on " << path << ": " << std::strerror(errno) << std::endl;
+            close(listen_fd);
+            return 1;
+        }
+        DEBUG_PRINT("Listening on " << path);
+
+        int ret = serve(listen_fd);
+
+        for (auto& s : sessions) {
+            if (!s.closed) close(s.in_fd);
+        }
+        close(listen_fd);
+        unlink(path.c_str());
+        return ret;
+    }
+
+private:
+    ResourceVector available;
+    ResourceMatrix allocation;
+    ResourceMatrix need;
+    std::size_t max_batch;
+    WhatIfEvaluator evaluator;
+
+    std::vector<Session> sessions;
+    std::list<PendingRequest> pending;
+    long next_ticket = 1;
+    bool shutdown = false;
+    std::string checkpoint_path;
+    bool modified = false;     // 上次写快照后状态是否有变化
+    std::chrono::milliseconds checkpoint_interval{1000};
+    metrics_clock::time_point last_checkpoint{};
+
+    static constexpr std::size_t max_outbuf = 1 << 20;
+    static constexpr int shutdown_drain_ms = 1000;
+
+    int serve(int listen_fd) {
+        std::signal(SIGPIPE, SIG_IGN);
+        std::signal(SIGINT, daemon_signal_handler);
+        std::signal(SIGTERM, daemon_signal_handler);
+
+        std::vector<pollfd> fds;
+        std::vector<std::size_t> fd_session;
+        while (!shutdown && !daemon_stop) {
+            fds.clear();
+            fd_session.clear();
+            if (listen_fd >= 0) {
+                fds.push_back(pollfd{listen_fd, POLLIN, 0});
+                fd_session.push_back(sessions.size());
+            }
+            bool buffered = false;
+            for (std::size_t i = 0; i < sessions.size(); ++i) {
+                const Session& s = sessions[i];
+                if (s.closed) continue;
+                buffered |= s.inbuf.find('\n') != std::string::npos;
+                const bool reading = !s.eof && s.outbuf.size() < max_outbuf;
+                const bool writing = !s.outbuf.empty();
+                if (s.in_fd == s.out_fd) {
+                    if (!reading && !writing) continue;
+                    fds.push_back(pollfd{s.in_fd, static_cast<short>((reading ? POLLIN : 0) | (writing ? POLLOUT : 0)), 0});
+                    fd_session.push_back(i);
+                    continue;
+                }
+                if (reading) {
+                    fds.push_back(pollfd{s.in_fd, POLLIN, 0});
+                    fd_session.push_back(i);
+                }
+                if (writing) {
+                    fds.push_back(pollfd{s.out_fd, POLLOUT, 0});
+                    fd_session.push_back(i);
+                }
+            }
+            if (listen_fd < 0 && fds.empty() && !buffered) {
+                break;
+            }
+
+            if (poll(fds.data(), fds.size(), buffered ? 0 : checkpoint_timeout()) < 0) {
+                if (errno == EINTR) continue;
+                std::cerr << "poll failed: " << std::strerror(errno) << std::endl;
+                return 1;
+            }
+
+            for (std::size_t k = 0; k < fds.size(); ++k) {
+                const short revents = fds[k].revents;
+                if (!revents) continue;
+                if (fds[k].fd == listen_fd) {
+                    int client = accept(listen_fd, nullptr, nullptr);
+                    if (client >= 0 && fcntl(client, F_SETFL, fcntl(client, F_GETFL) | O_NONBLOCK) == 0) {
+                        DEBUG_PRINT("Client connected, fd " << client);
+                        add_session(Session{client, client});
+                    } else if (client >= 0) {
+                        close(client);
+                    }
+                    continue;
+                }
+                Session& s = sessions[fd_session[k]];
+                if ((fds[k].events & POLLOUT) && (revents & (POLLOUT | POLLHUP | POLLERR))) {
+                    flush_session(s);
+                }
+                if ((fds[k].events & POLLIN) && (revents & (POLLIN | POLLHUP | POLLERR))) {
+                    read_session(fd_session[k]);
+                }
+            }
+
+            std::vector<Command> batch = collect_batch();
+            if (!batch.empty()) {
+                process_batch(batch);
+            }
+            checkpoint(false);
+            flush_sessions();
+        }
+        checkpoint(true);
+        drain_sessions(shutdown_drain_ms);
+        return 0;
+    }
+
+    void read_session(std::size_t idx) {
+        Session& s = sessions[idx];
+        char buf[65536];
+        ssize_t n = read(s.in_fd, buf, sizeof(buf));
+        if (n > 0) {
+            s.inbuf.append(buf, n);
+        } else if (n == 0 || (errno != EINTR && errno != EAGAIN)) {
+            s.eof = true;
+            if (!s.inbuf.empty() && s.inbuf.back() != '\n') {
+                s.inbuf.push_back('\n');
+            }
+        }
+    }
+
+    std::vector<Command> collect_batch() {
+        std::vector<Command> batch;
+        bool progress = true;
+        // 各连接轮流取一行，避免单个客户端独占批次
+        while (progress && batch.size() < max_batch) {
+            progress = false;
+            for (std::size_t i = 0; i < sessions.size() && batch.size() < max_batch; ++i) {
+                Session& s = sessions[i];
+                if (s.closed) continue;
+                std::size_t pos = s.inbuf.find('\n');
+                if (pos == std::string::npos) continue;
+                batch.push_back(Command{i, s.inbuf.substr(0, pos)});
+                s.inbuf.erase(0, pos + 1);
+                progress = true;
+            }
+        }
+        return batch;
+    }
+
+    void process_batch(const std::vector<Command>& batch) {
+        DEBUG_PRINT("Processing batch of " << batch.size() << " command(s)");
+        bool released = false;
+        for (const auto& cmd : batch) {
+            if (sessions[cmd.session].ended) continue;
+            try {
+                released |= execute(cmd);
+            } catch (const std::exception& e) {
+                reply(cmd.session, std::string("ERROR ") + e.what());
+            }
+        }
+        if (released) {
+            retry_pending();
+        }
+    }
+
+    // 有未写入的变化时，距下次允许写快照的毫秒数；无需写快照时为 -1（poll 无限等待）
+    int checkpoint_timeout() const {
+        if (!modified || checkpoint_path.empty()) return -1;
+        const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+            last_checkpoint + checkpoint_interval - metrics_clock::now()).count();
+        return left > 0 ? static_cast<int>(left) : 0;
+    }
+
+    // 写出失败时同样等待一个间隔再重试，避免在事件循环上反复 fsync
+    void checkpoint(bool force) {
+        if (!force && checkpoint_timeout() != 0) return;
+        if (!modified || checkpoint_path.empty()) return;
+        last_checkpoint = metrics_clock::now();
+        try {
+            save_snapshot(checkpoint_path, available, allocation, need);
+            modified = false;
+            DEBUG_PRINT("Checkpoint written to " << checkpoint_path);
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+        }
+    }
+
+    // 返回值表示该命令是否释放了资源
+    bool execute(const Command& cmd) {
+        std::istringstream ss(cmd.line);
+        std::string op;
+        if (!(ss >> op)) return false;
+
+        if (op == "request") {
+            int id;
+            std::string vec;
+            if (!(ss >> id >> vec)) {
+                reply(cmd.session, "ERROR usage: request <id> <r1,r2,...>");
+                return false;
+            }
+            std::vector<int> parsed = parseVector(vec);
+            if (!check_request(cmd.session, id, parsed)) return false;
+            ResourceVector request(parsed);
+            result res = banker_allocate(available, allocation, need, request, id);
+            if (res == result::WAIT) {
+                long ticket = next_ticket++;
+                pending.push_back(PendingRequest{cmd.session, ticket, id, std::move(request)});
+                reply(cmd.session, "WAIT " + std::to_string(ticket));
+            } else {
+                modified |= res == result::SUCCESS;
+                reply(cmd.session, result_name(res));
+            }
+            return false;
+        }
+        if (op == "release") {
+            int id;
+            if (!(ss >> id)) {
+                reply(cmd.session, "ERROR usage: release <id> [r1,r2,...]");
+                return false;
+            }
+            std::string vec;
+            std::vector<int> parsed;
+            if (ss >> vec) {
+                parsed = parseVector(vec);
+            } else if (id >= 0 && id < static_cast<int>(allocation.rows())) {
+                parsed = allocation.row_vector(id);
+            }
+            if (!check_request(cmd.session, id, parsed)) return false;
+            if (!banker_release(available, allocation, need, ResourceVector(parsed), id)) {
+                reply(cmd.session, "ERROR release exceeds allocation");
+                return false;
+            }
+            modified = true;
+            reply(cmd.session, "RELEASED");
+            return true;
+        }
+        if (op == "query") {
+            int id;
+            std::ostringstream out;
+            if (ss >> id) {
+                if (id < 0 || id >= static_cast<int>(allocation.rows())) {
+                    reply(cmd.session, "ERROR process id out of range");
+                    return false;
+                }
+                out << "PROCESS " << id << " ALLOCATION " << allocation.row_vector(id) << " NEED " << need.row_vector(id);
+            } else {
+                out << "AVAILABLE " << available << " PENDING " << pending.size();
+            }
+            reply(cmd.session, out.str());
+            return false;
+        }
+        if (op == "whatif") {
+            std::vector<Candidate> candidates;
+            int id;
+            std::string vec;
+            while (ss >> id >> vec) {
+                std::vector<int> parsed = parseVector(vec);
+                if (!check_request(cmd.session, id, parsed)) return false;
+                candidates.push_back(Candidate{id, ResourceVector(parsed)});
+            }
+            if (candidates.empty()) {
+                reply(cmd.session, "ERROR usage: whatif <id> <r1,r2,...> [<id> <r1,r2,...> ...]");
+                return false;
+            }
+            std::string out = "WHATIF";
+            for (result res : evaluator.evaluate(available, allocation, need, candidates)) {
+                out += ' ';
+                out += result_name(res);
+            }
+            reply(cmd.session, out);
+            return false;
+        }
+        if (op == "checkpoint") {
+            std::string path = checkpoint_path;
+            ss >> path;
+            if (path.empty()) {
+                reply(cmd.session, "ERROR usage: checkpoint <path>");
+                return false;
+            }
+            save_snapshot(path, available, allocation, need);
+            if (path == checkpoint_path) modified = false;
+            reply(cmd.session, "CHECKPOINT " + path);
+            return false;
+        }
+        if (op == "stats") {
+            std::ostringstream out;
+            out << "STATS ";
+            banker_metrics.write_json(out);
+            reply(cmd.session, out.str());
+            return false;
+        }
+        if (op == "quit") {
+            end_session(cmd.session);
+            return false;
+        }
+        if (op == "shutdown") {
+            reply(cmd.session, "BYE");
+            shutdown = true;
+            return false;
+        }
+        reply(cmd.session, "ERROR unknown command: " + op);
+        return false;
+    }
+
+    bool check_request(std::size_t session, int id, const std::vector<int>& request) {
+        if (id < 0 || id >= static_cast<int>(allocation.rows())) {
+            reply(session, "ERROR process id out of range");
+            return false;
+        }
+        if (request.size() != available.size()) {
+            reply(session, "ERROR vector size must match the number of resources");
+            return false;
+        }
+        // 负分量会让 request 变成归还、release 变成申请，绕过安全性检查
+        for (int r : request) {
+            if (r < 0) {
+                reply(session, "ERROR vector components must be non-negative");
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // 授予请求只会减少 available，不会使同批中更早的请求变得可满足，故单次遍历即可
+    void retry_pending() {
+        DEBUG_PRINT("Retrying " << pending.size() << " pending request(s)");
+        for (auto it = pending.begin(); it != pending.end();) {
+            if (sessions[it->session].ended) {
+                it = pending.erase(it);
+                continue;
+            }
+            result res = banker_allocate(available, allocation, need, it->request, it->id);
+            if (res == result::WAIT) {
+                ++it;
+                continue;
+            }
+            modified |= res == result::SUCCESS;
+            reply(it->session, std::string(result_name(res)) + " " + std::to_string(it->ticket));
+            it = pending.erase(it);
+        }
+    }
+
+    // 已关闭连接的挂起请求在 close_session 中一并清除，其槽位可直接复用
+    void add_session(Session s) {
+        for (auto& slot : sessions) {
+            if (slot.closed) {
+                slot = std::move(s);
+                return;
+            }
+        }
+        sessions.push_back(std::move(s));
+    }
+
+    void reply(std::size_t session, const std::string& line) {
+        sessions[session].outbuf += line;
+        sessions[session].outbuf += '\n';
+    }
+
+    // 不再接受该连接的命令并丢弃其挂起请求；已排队的回复发送完后由 flush_sessions 关闭连接
+    void end_session(std::size_t idx) {
+        Session& s = sessions[idx];
+        s.eof = s.ended = true;
+        s.inbuf.clear();
+        for (auto it = pending.begin(); it != pending.end();) {
+            it = it->session == idx ? pending.erase(it) : std::next(it);
+        }
+    }
+
+    void close_session(std::size_t idx) {
+        Session& s = sessions[idx];
+        if (s.closed) return;
+        flush_session(s);
+        end_session(idx);
+        s.closed = true;
+        if (s.in_fd != STDIN_FILENO) close(s.in_fd);
+        DEBUG_PRINT("Session " << idx << " closed");
+    }
+
+    // 写出 outbuf 中能写的部分，剩余部分留待下次 POLLOUT；写出错时丢弃输出并结束该连接
+    void flush_session(Session& s) {
+        std::size_t off = 0;
+        while (off < s.outbuf.size()) {
+            ssize_t n = write(s.out_fd, s.outbuf.data() + off, s.outbuf.size() - off);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+                DEBUG_PRINT("Write failed: " << std::strerror(errno));
+                s.eof = s.ended = true;
+                s.inbuf.clear();
+                off = s.outbuf.size();
+                break;
+            }
+            off += n;
+        }
+        s.outbuf.erase(0, off);
+    }
+
+    void flush_sessions() {
+        for (std::size_t i = 0; i < sessions.size(); ++i) {
+            Session& s = sessions[i];
+            if (s.closed) continue;
+            flush_session(s);
+            if (s.eof && s.inbuf.empty() && s.outbuf.empty() && s.in_fd != STDIN_FILENO) {
+                close_session(i);
+            }
+        }
+    }
+
+    // 退出前在 timeout_ms 内尽量发送各连接剩余的回复
+    void drain_sessions(int timeout_ms) {
+        const auto deadline = metrics_clock::now() + std::chrono::milliseconds(timeout_ms);
+        std::vector<pollfd> fds;
+        std::vector<std::size_t> fd_session;
+        while (true) {
+            flush_sessions();
+            fds.clear();
+            fd_session.clear();
+            for (std::size_t i = 0; i < sessions.size(); ++i) {
+                if (sessions[i].closed || sessions[i].outbuf.empty()) continue;
+                fds.push_back(pollfd{sessions[i].out_fd, POLLOUT, 0});
+                fd_session.push_back(i);
+            }
+            const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - metrics_clock::now()).count();
+            if (fds.empty() || left <= 0) break;
+            if (poll(fds.data(), fds.size(), left) < 0 && errno != EINTR) break;
+        }
+        for (std::size_t i = 0; i < sessions.size(); ++i) {
+            if (!sessions[i].outbuf.empty()) DEBUG_PRINT("Dropping " << sessions[i].outbuf.size() << " unsent byte(s) of session " << i);
+        }
+    }
+};
+
+
+#endif // DAEMON_HPP
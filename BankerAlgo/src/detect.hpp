@@ -0,0 +1,150 @@
+#ifndef DETECT_HPP
+#define DETECT_HPP
+
+#include "banker.hpp"
+#include <vector>
+
+// 多实例资源的死锁检测。
+//
+// 与安全性检查使用同一套规约（SafetyChecker::reduce），只是以当前未满足的请求矩阵 request 代替 need：
+// 未持有任何资源的进程不可能参与死锁，直接视为已完成；其余进程从 work = available 出发反复规约，
+// 规约结束后仍无法完成的进程即为死锁进程。
+//
+// 状态变化后不必每次都从头检测。规约的结果对 work 单调：work 变大、请求变小只会让更多进程完成，
+// 已完成的进程仍可按原顺序完成。因此记录上次规约结束时的 work（final_work）：
+//   - 释放资源、缩小请求：已完成集合保持有效，只需从 final_work 出发对上次的死锁进程续做规约；
+//   - 死锁进程的新请求逐项不小于原请求：结果不变；其他改变只需对死锁进程续做规约；
+//   - 未持有资源的进程改变请求：结果不变；
+//   - 授予资源，或已完成进程的请求有任一项增大：可能破坏原完成顺序，下次检测时从头规约。
+// detect() 只在状态确有变化时才计算，可以在每批状态变化之后周期性调用。
+
+
+struct DetectorStats {
+    std::size_t full_runs = 0;         // 从头规约的次数
+    std::size_t incremental_runs = 0;  // 只对上次死锁进程续做规约的次数
+    std::size_t skipped = 0;           // 状态未变、直接返回上次结果的次数
+};
+
+
+class DeadlockDetector {
+public:
+    DeadlockDetector(ResourceVector available, ResourceMatrix allocation, ResourceMatrix request)
+        : available(std::move(available)),
+          allocation(std::move(allocation)),
+          request(std::move(request)),
+          in_deadlock(this->allocation.rows(), 0) {}
+
+    // 满足进程 id 的部分请求：available -= grant, allocation += grant, request -= grant
+    bool grant(int id, const ResourceVector& grant) {
+        if (!valid(id, grant)) return false;
+        const std::size_t stride = available.stride();
+        int* request_row = request.row(id);
+        if (!vec_le(grant.data(), request_row, stride) || !vec_le(grant.data(), available.data(), stride)) {
+            return false;
+        }
+        apply_request(available.data(), allocation.row(id), request_row, grant.data(), stride);
+        pending = change::FULL;
+        return true;
+    }
+
+    // 进程 id 归还资源：available += release, allocation -= release
+    bool release(int id, const ResourceVector& release) {
+        if (!valid(id, release)) return false;
+        const std::size_t stride = available.stride();
+        int* alloc_row = allocation.row(id);
+        if (!vec_le(release.data(), alloc_row, stride)) {
+            return false;
+        }
+        vec_add(available.data(), release.data(), stride);
+        vec_sub(alloc_row, release.data(), stride);
+        // 已完成进程的归还不改变 final_work；死锁进程归还的资源直接可用
+        if (in_deadlock[id]) {
+            vec_add(final_work.data(), release.data(), stride);
+            mark(change::RECHECK);
+        }
+        return true;
+    }
+
+    // 把进程 id 未满足的请求替换为 new_request
+    bool set_request(int id, const ResourceVector& new_request) {
+        if (!valid(id, new_request)) return false;
+        const std::size_t stride = available.stride();
+        int* request_row = request.row(id);
+        const bool shrinks = vec_le(new_request.data(), request_row, stride);
+        const bool grows = vec_le(request_row, new_request.data(), stride);
+        const bool holds = !vec_le(allocation.row(id), zero.data(), stride);
+        for (std::size_t j = 0; j < stride; ++j) request_row[j] = new_request[j];
+        if (in_deadlock[id]) {
+            // 只有逐项不减时才确定仍然死锁；逐项不可比的变化也可能使其完成
+            if (!grows) mark(change::RECHECK);
+        } else if (holds && !shrinks) {
+            pending = change::FULL;
+        }
+        return true;
+    }
+
+    // 返回死锁进程号（升序）
+    const std::vector<int>& detect() {
+        if (pending == change::NONE) {
+            ++counters.skipped;
+            return deadlocked;
+        }
+        const std::size_t stride = available.stride();
+        if (pending == change::FULL) {
+            ++counters.full_runs;
+            DEBUG_PRINT("Running full deadlock detection...");
+            deadlocked.clear();
+            for (std::size_t i = 0; i < allocation.rows(); ++i) {
+                if (!vec_le(allocation.row(i), zero.data(), stride)) deadlocked.push_back(i);
+            }
+            checker.reduce(available, allocation, request, deadlocked);
+        } else {
+            ++counters.incremental_runs;
+            DEBUG_PRINT("Rechecking " << deadlocked.size() << " deadlocked process(es)...");
+            std::size_t kept = 0;
+            for (int id : deadlocked) {
+                if (!vec_le(allocation.row(id), zero.data(), stride)) deadlocked[kept++] = id;
+            }
+            deadlocked.resize(kept);
+            checker.reduce(final_work, allocation, request, deadlocked);
+        }
+        final_work = checker.final_work();
+        std::fill(in_deadlock.begin(), in_deadlock.end(), 0);
+        for (int id : deadlocked) in_deadlock[id] = 1;
+        pending = change::NONE;
+        DEBUG_PRINT("Deadlocked processes: " << deadlocked);
+        return deadlocked;
+    }
+
+    const ResourceVector& available_vector() const { return available; }
+    const ResourceMatrix& allocation_matrix() const { return allocation; }
+    const ResourceMatrix& request_matrix() const { return request; }
+    const DetectorStats& stats() const { return counters; }
+
+private:
+    enum class change { NONE, RECHECK, FULL };
+
+    ResourceVector available;
+    ResourceMatrix allocation;
+    ResourceMatrix request;
+    ResourceVector zero{available.size()};
+    ResourceVector final_work;             // 上次规约结束时的 work
+    std::vector<int> deadlocked;
+    std::vector<char> in_deadlock;
+    change pending = change::FULL;
+    SafetyChecker checker;
+    DetectorStats counters;
+
+    // 负分量会让 grant/release 反向改动状态而绕过上界检查
+    bool valid(int id, const ResourceVector& vec) const {
+        return id >= 0 && id < static_cast<int>(allocation.rows()) && vec.size() == available.size()
+            && vec_nonneg(vec.data(), vec.stride());
+    }
+
+    void mark(change c) {
+        if (pending == change::NONE) pending = c;
+    }
+};
+
+
+#endif // DETECT_HPP
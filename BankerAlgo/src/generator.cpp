@@ -0,0 +1,34 @@
+#include "generator.hpp"
+#include "state_io.hpp"
+#include <iostream>
+#include <string>
+
+
+int main(int argc, char *argv[]) {
+    if (argc < 4) {
+        std::cerr << "Usage: " << argv[0] << " <processes> <resources> <safe|unsafe|deadlock> [seed] [--snapshot file]" << std::endl;
+        return 1;
+    }
+    const std::size_t n = std::stoul(argv[1]);
+    const std::size_t m = std::stoul(argv[2]);
+    const unsigned seed = argc > 4 && std::string(argv[4]) != "--snapshot" ? std::stoul(argv[4]) : 2025;
+    std::string snapshot;
+    for (int i = 4; i + 1 < argc; ++i) {
+        if (std::string(argv[i]) == "--snapshot") snapshot = argv[i + 1];
+    }
+
+    GeneratedState s;
+    try {
+        s = generate_state(n, m, parse_state_kind(argv[3]), seed);
+        if (!snapshot.empty()) {
+            save_snapshot(snapshot, s.available, s.allocation, s.need);
+            return 0;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    std::ios::sync_with_stdio(false);
+    write_state(std::cout, s);
+    return 0;
+}
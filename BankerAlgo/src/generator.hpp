@@ -0,0 +1,107 @@
+#ifndef GENERATOR_HPP
+#define GENERATOR_HPP
+
+#include "matrix.hpp"
+#include "state_io.hpp"
+#include <iostream>
+#include <vector>
+#include <string>
+#include <random>
+#include <numeric>
+#include <algorithm>
+#include <stdexcept>
+
+// 按种子生成大规模随机状态，同一组参数总是得到相同的状态。
+//
+// 先随机取一个完成顺序，按该顺序反推 available，使顺序中的进程依次完成时恰好不缺资源（SAFE）。
+// UNSAFE 与 DEADLOCK 另取约 n/10 个进程组成卡死组：每人至少持有每类资源各 1 个，
+// 并在某一类资源 j 上需要 W[j] + (组内其他人持有的 j)，W 为其余进程全部完成后的 work，
+// 即最大需求恰为资源总量。组内至少两人，所需总大于 W[j]，无人能先完成，W 也就不再增长，
+// 整组永远无法完成，而其余进程都能完成。组内个别进程少量归还资源或缩小请求也不会使整组解除。
+// DEADLOCK 的第三个矩阵表示当前未满足的请求；另有约 n/20 个不持有资源、请求无法满足的进程，
+// 它们只是在等待而不属于死锁。
+
+
+enum class state_kind { SAFE, UNSAFE, DEADLOCK };
+
+struct GeneratedState {
+    ResourceVector available;
+    ResourceMatrix allocation;
+    ResourceMatrix need;          // DEADLOCK 时为请求矩阵
+    std::vector<int> stuck;       // 无法完成的进程（升序），SAFE 时为空
+};
+
+state_kind parse_state_kind(const std::string& name) {
+    if (name == "safe") return state_kind::SAFE;
+    if (name == "unsafe") return state_kind::UNSAFE;
+    if (name == "deadlock") return state_kind::DEADLOCK;
+    throw std::invalid_argument("State kind must be safe, unsafe or deadlock");
+}
+
+GeneratedState generate_state(std::size_t n, std::size_t m, state_kind kind, unsigned seed) {
+    if (kind != state_kind::SAFE && (n < 2 || m < 1)) {
+        throw std::invalid_argument("Unsafe and deadlocked states need at least 2 processes and 1 resource");
+    }
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<int> dist_alloc(0, 3);
+    std::uniform_int_distribution<int> dist_need(0, 8);
+    std::uniform_int_distribution<std::size_t> dist_resource(0, m - 1);
+
+    GeneratedState s{ResourceVector(m), ResourceMatrix(n, m), ResourceMatrix(n, m), {}};
+    for (std::size_t i = 0; i < n; ++i) {
+        for (std::size_t j = 0; j < m; ++j) {
+            s.allocation(i, j) = dist_alloc(gen);
+            s.need(i, j) = dist_need(gen);
+        }
+    }
+
+    std::vector<int> seq(n);
+    std::iota(seq.begin(), seq.end(), 0);
+    std::shuffle(seq.begin(), seq.end(), gen);
+    const std::size_t stuck = kind == state_kind::SAFE ? 0 : std::max<std::size_t>(2, n / 10);
+    const std::size_t idle = kind == state_kind::DEADLOCK ? std::min(n - stuck, n / 20) : 0;
+
+    // 完成顺序 seq[stuck + idle ..]，available[j] = max_k (need[seq_k][j] - sum_{l<k} allocation[seq_l][j])
+    ResourceVector freed(m);
+    for (std::size_t k = stuck + idle; k < n; ++k) {
+        const int id = seq[k];
+        for (std::size_t j = 0; j < m; ++j) {
+            s.available[j] = std::max(s.available[j], s.need(id, j) - freed[j]);
+            freed[j] += s.allocation(id, j);
+        }
+    }
+    // W = available + 已完成进程的 allocation
+    ResourceVector work = s.available;
+    vec_add(work.data(), freed.data(), work.stride());
+
+    // total = W + 卡死组持有的资源
+    ResourceVector total = work;
+    for (std::size_t k = 0; k < stuck; ++k) {
+        const int id = seq[k];
+        for (std::size_t j = 0; j < m; ++j) s.allocation(id, j) = 1 + dist_alloc(gen);
+        vec_add(total.data(), s.allocation.row(id), total.stride());
+    }
+    for (std::size_t k = 0; k < stuck; ++k) {
+        const int id = seq[k];
+        const std::size_t j = dist_resource(gen);
+        s.need(id, j) = total[j] - s.allocation(id, j);
+        s.stuck.push_back(id);
+    }
+    for (std::size_t k = stuck; k < stuck + idle; ++k) {
+        const int id = seq[k];
+        for (std::size_t j = 0; j < m; ++j) s.allocation(id, j) = 0;
+        const std::size_t j = dist_resource(gen);
+        s.need(id, j) = work[j] + 1;
+    }
+    std::sort(s.stuck.begin(), s.stuck.end());
+    return s;
+}
+
+
+// 以命令行参数的格式输出：Available、Allocation、Need（或 Request）各占一行，也即文本状态文件
+void write_state(std::ostream& os, const GeneratedState& s) {
+    write_text_state(os, s.available, s.allocation, s.need);
+}
+
+
+#endif // GENERATOR_HPP
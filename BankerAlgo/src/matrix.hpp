@@ -0,0 +1,280 @@
+#ifndef MATRIX_HPP
+#define MATRIX_HPP
+
+#include <iostream>
+#include <vector>
+#include <new>
+#include <cstddef>
+#include <stdexcept>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+// 连续存储的资源向量与矩阵。
+//
+// 矩阵按行优先存放在一块 32 字节对齐的缓冲区中，每行补零到 RESOURCE_LANES 的整数倍（stride），
+// 因此每一行都从对齐地址开始，向量运算可以整块处理而无需尾部特判。补齐部分恒为 0，
+// 不影响比较与加减的结果。向量运算在编译器开启 AVX2 时使用 256 位指令，否则退回标量循环。
+
+
+constexpr std::size_t RESOURCE_LANES = 8;       // 每个 256 位寄存器容纳的 int 个数
+constexpr std::size_t RESOURCE_ALIGNMENT = 32;
+
+inline std::size_t padded_width(std::size_t cols) {
+    return (cols + RESOURCE_LANES - 1) / RESOURCE_LANES * RESOURCE_LANES;
+}
+
+
+template <typename T>
+struct AlignedAllocator {
+    using value_type = T;
+
+    AlignedAllocator() = default;
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U>&) {}
+
+    T* allocate(std::size_t n) {
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(RESOURCE_ALIGNMENT)));
+    }
+    void deallocate(T* p, std::size_t) {
+        ::operator delete(p, std::align_val_t(RESOURCE_ALIGNMENT));
+    }
+
+    template <typename U>
+    bool operator==(const AlignedAllocator<U>&) const { return true; }
+    template <typename U>
+    bool operator!=(const AlignedAllocator<U>&) const { return false; }
+};
+
+using aligned_buffer = std::vector<int, AlignedAllocator<int>>;
+
+
+class ResourceVector {
+public:
+    ResourceVector() = default;
+    explicit ResourceVector(std::size_t size)
+        : n_size(size), buf(padded_width(size), 0) {}
+    ResourceVector(const std::vector<int>& v)
+        : ResourceVector(v.size()) {
+        for (std::size_t j = 0; j < n_size; ++j) buf[j] = v[j];
+    }
+
+    std::size_t size() const { return n_size; }
+    std::size_t stride() const { return buf.size(); }
+    bool empty() const { return n_size == 0; }
+
+    int* data() { return buf.data(); }
+    const int* data() const { return buf.data(); }
+    int& operator[](std::size_t j) { return buf[j]; }
+    const int& operator[](std::size_t j) const { return buf[j]; }
+
+    std::vector<int> to_vector() const {
+        return std::vector<int>(buf.begin(), buf.begin() + n_size);
+    }
+
+private:
+    std::size_t n_size = 0;
+    aligned_buffer buf;
+};
+
+
+class ResourceMatrix {
+public:
+    ResourceMatrix() = default;
+    ResourceMatrix(std::size_t rows, std::size_t cols)
+        : n_rows(rows), n_cols(cols), n_stride(padded_width(cols)), buf(rows * n_stride, 0) {}
+    ResourceMatrix(const std::vector<std::vector<int>>& m, std::size_t cols)
+        : ResourceMatrix(m.size(), cols) {
+        for (std::size_t i = 0; i < n_rows; ++i) {
+            if (m[i].size() != n_cols) {
+                throw std::invalid_argument("Matrix rows must have the same number of columns");
+            }
+            int* r = row(i);
+            for (std::size_t j = 0; j < n_cols; ++j) r[j] = m[i][j];
+        }
+    }
+
+    std::size_t rows() const { return n_rows; }
+    std::size_t cols() const { return n_cols; }
+    std::size_t stride() const { return n_stride; }
+
+    int* data() { return buf.data(); }
+    const int* data() const { return buf.data(); }
+    int* row(std::size_t i) { return buf.data() + i * n_stride; }
+    const int* row(std::size_t i) const { return buf.data() + i * n_stride; }
+    int& operator()(std::size_t i, std::size_t j) { return buf[i * n_stride + j]; }
+    const int& operator()(std::size_t i, std::size_t j) const { return buf[i * n_stride + j]; }
+
+    std::vector<int> row_vector(std::size_t i) const {
+        return std::vector<int>(row(i), row(i) + n_cols);
+    }
+    std::vector<std::vector<int>> to_nested() const {
+        std::vector<std::vector<int>> m(n_rows);
+        for (std::size_t i = 0; i < n_rows; ++i) m[i] = row_vector(i);
+        return m;
+    }
+
+private:
+    std::size_t n_rows = 0;
+    std::size_t n_cols = 0;
+    std::size_t n_stride = 0;
+    aligned_buffer buf;
+};
+
+
+// ---- 向量运算，所有指针均指向对齐且补齐到 stride 的行 ----
+
+// all(a <= b)，无提前退出
+inline bool vec_le(const int* a, const int* b, std::size_t stride) {
+#ifdef __AVX2__
+    __m256i gt = _mm256_setzero_si256();
+    for (std::size_t j = 0; j < stride; j += RESOURCE_LANES) {
+        __m256i va = _mm256_load_si256(reinterpret_cast<const __m256i*>(a + j));
+        __m256i vb = _mm256_load_si256(reinterpret_cast<const __m256i*>(b + j));
+        gt = _mm256_or_si256(gt, _mm256_cmpgt_epi32(va, vb));
+    }
+    return _mm256_testz_si256(gt, gt);
+#else
+    int gt = 0;
+    for (std::size_t j = 0; j < stride; ++j) gt |= a[j] > b[j];
+    return !gt;
+#endif
+}
+
+// all(a >= 0)，补齐部分为 0 不影响结果
+inline bool vec_nonneg(const int* a, std::size_t stride) {
+#ifdef __AVX2__
+    __m256i neg = _mm256_setzero_si256();
+    for (std::size_t j = 0; j < stride; j += RESOURCE_LANES) {
+        neg = _mm256_or_si256(neg, _mm256_load_si256(reinterpret_cast<const __m256i*>(a + j)));
+    }
+    return !_mm256_movemask_ps(_mm256_castsi256_ps(neg));
+#else
+    int neg = 0;
+    for (std::size_t j = 0; j < stride; ++j) neg |= a[j] < 0;
+    return !neg;
+#endif
+}
+
+// 返回 from 之后第一个 a[j] > b[j] 的下标，不存在时返回 stride
+inline std::size_t vec_first_gt(const int* a, const int* b, std::size_t from, std::size_t stride) {
+#ifdef __AVX2__
+    std::size_t j = from / RESOURCE_LANES * RESOURCE_LANES;
+    unsigned skip = ~0u << (from - j);
+    for (; j < stride; j += RESOURCE_LANES) {
+        __m256i va = _mm256_load_si256(reinterpret_cast<const __m256i*>(a + j));
+        __m256i vb = _mm256_load_si256(reinterpret_cast<const __m256i*>(b + j));
+        unsigned mask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(va, vb))) & skip;
+        if (mask) return j + __builtin_ctz(mask);
+        skip = ~0u;
+    }
+    return stride;
+#else
+    std::size_t j = from;
+    while (j < stride && a[j] <= b[j]) ++j;
+    return j;
+#endif
+}
+
+// a += b
+inline void vec_add(int* a, const int* b, std::size_t stride) {
+#ifdef __AVX2__
+    for (std::size_t j = 0; j < stride; j += RESOURCE_LANES) {
+        __m256i va = _mm256_load_si256(reinterpret_cast<const __m256i*>(a + j));
+        __m256i vb = _mm256_load_si256(reinterpret_cast<const __m256i*>(b + j));
+        _mm256_store_si256(reinterpret_cast<__m256i*>(a + j), _mm256_add_epi32(va, vb));
+    }
+#else
+    for (std::size_t j = 0; j < stride; ++j) a[j] += b[j];
+#endif
+}
+
+// a -= b
+inline void vec_sub(int* a, const int* b, std::size_t stride) {
+#ifdef __AVX2__
+    for (std::size_t j = 0; j < stride; j += RESOURCE_LANES) {
+        __m256i va = _mm256_load_si256(reinterpret_cast<const __m256i*>(a + j));
+        __m256i vb = _mm256_load_si256(reinterpret_cast<const __m256i*>(b + j));
+        _mm256_store_si256(reinterpret_cast<__m256i*>(a + j), _mm256_sub_epi32(va, vb));
+    }
+#else
+    for (std::size_t j = 0; j < stride; ++j) a[j] -= b[j];
+#endif
+}
+
+// 试分配：available -= request, allocation += request, need -= request，一次遍历完成
+inline void apply_request(int* available, int* alloc_row, int* need_row, const int* request, std::size_t stride) {
+#ifdef __AVX2__
+    for (std::size_t j = 0; j < stride; j += RESOURCE_LANES) {
+        __m256i vr = _mm256_load_si256(reinterpret_cast<const __m256i*>(request + j));
+        __m256i* pa = reinterpret_cast<__m256i*>(available + j);
+        __m256i* pl = reinterpret_cast<__m256i*>(alloc_row + j);
+        __m256i* pn = reinterpret_cast<__m256i*>(need_row + j);
+        _mm256_store_si256(pa, _mm256_sub_epi32(_mm256_load_si256(pa), vr));
+        _mm256_store_si256(pl, _mm256_add_epi32(_mm256_load_si256(pl), vr));
+        _mm256_store_si256(pn, _mm256_sub_epi32(_mm256_load_si256(pn), vr));
+    }
+#else
+    for (std::size_t j = 0; j < stride; ++j) {
+        available[j] -= request[j];
+        alloc_row[j] += request[j];
+        need_row[j] -= request[j];
+    }
+#endif
+}
+
+// apply_request 的逆操作，也用于进程归还资源
+inline void revert_request(int* available, int* alloc_row, int* need_row, const int* request, std::size_t stride) {
+#ifdef __AVX2__
+    for (std::size_t j = 0; j < stride; j += RESOURCE_LANES) {
+        __m256i vr = _mm256_load_si256(reinterpret_cast<const __m256i*>(request + j));
+        __m256i* pa = reinterpret_cast<__m256i*>(available + j);
+        __m256i* pl = reinterpret_cast<__m256i*>(alloc_row + j);
+        __m256i* pn = reinterpret_cast<__m256i*>(need_row + j);
+        _mm256_store_si256(pa, _mm256_add_epi32(_mm256_load_si256(pa), vr));
+        _mm256_store_si256(pl, _mm256_sub_epi32(_mm256_load_si256(pl), vr));
+        _mm256_store_si256(pn, _mm256_add_epi32(_mm256_load_si256(pn), vr));
+    }
+#else
+    for (std::size_t j = 0; j < stride; ++j) {
+        available[j] += request[j];
+        alloc_row[j] -= request[j];
+        need_row[j] += request[j];
+    }
+#endif
+}
+
+
+std::ostream& operator<<(std::ostream& os, const ResourceVector& vec) {
+    os << "[";
+    for (std::size_t j = 0; j < vec.size(); ++j) {
+        os << vec[j];
+        if (j != vec.size() - 1) {
+            os << ", ";
+        }
+    }
+    os << "]";
+    return os;
+}
+
+std::ostream& operator<<(std::ostream& os, const ResourceMatrix& matrix) {
+    os << "[";
+    for (std::size_t i = 0; i < matrix.rows(); ++i) {
+        os << "[";
+        for (std::size_t j = 0; j < matrix.cols(); ++j) {
+            os << matrix(i, j);
+            if (j != matrix.cols() - 1) {
+                os << ", ";
+            }
+        }
+        os << "]";
+        if (i != matrix.rows() - 1) {
+            os << "; ";
+        }
+    }
+    os << "]";
+    return os;
+}
+
+
+#endif // MATRIX_HPP
@@ -0,0 +1,160 @@
+#ifndef METRICS_HPP
+#define METRICS_HPP
+
+#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+
+// 进程内的计数器与计时器，可导出为 JSON。
+//
+// 热路径只做普通的成员自增：SafetyChecker 在一次检查内把扫描次数等累计在自身成员里，
+// 检查结束时才以 relaxed 原子加法并入 banker_metrics。决策与检查的计数器按线程分片：
+// 每个线程第一次记录时轮流分到一个独占缓存行的分片，之后只写自己的分片，
+// ConcurrentBanker 的合并者、WhatIfEvaluator 的各工作线程同时检查时不会争用同一缓存行；
+// 线程数超过分片数时才有线程共用分片。导出时把各分片求和。计时使用 steady_clock，每次决策两次读时钟。
+//
+// 各项含义：
+//   parse_ns        解析命令行参数或状态文件
+//   validation_ns   检查维度、进程号等输入合法性
+//   decisions       banker_allocate 的调用次数，按结果分为 success / wait / fail，decision_ns 为其总耗时
+//   safety_checks   安全性检查（含死锁检测的规约）次数，safety_ns 为其总耗时
+//   iterations      检查中扫描 need 行的次数（每次从 blocked_on 续扫计一次）
+//   requeues        扫描后仍被阻塞、重新放回待查集合（轮询保留或挂入等待堆）的次数
+//   sweeps          第一阶段按进程号轮询的轮数
+
+
+using metrics_clock = std::chrono::steady_clock;
+
+inline std::uint64_t elapsed_ns(metrics_clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(metrics_clock::now() - start).count();
+}
+
+
+// 各分片求和后的计数
+struct MetricsTotals {
+    std::uint64_t decisions[3] = {};    // 下标为 result 的值：FAIL, WAIT, SUCCESS
+    std::uint64_t decision_ns = 0;
+    std::uint64_t safety_checks = 0;
+    std::uint64_t safety_ns = 0;
+    std::uint64_t iterations = 0;
+    std::uint64_t requeues = 0;
+    std::uint64_t sweeps = 0;
+};
+
+
+struct BankerMetrics {
+    static constexpr std::size_t shard_count = 64;
+
+    struct alignas(64) Shard {
+        std::atomic<std::uint64_t> decisions[3] = {};
+        std::atomic<std::uint64_t> decision_ns{0};
+        std::atomic<std::uint64_t> safety_checks{0};
+        std::atomic<std::uint64_t> safety_ns{0};
+        std::atomic<std::uint64_t> iterations{0};
+        std::atomic<std::uint64_t> requeues{0};
+        std::atomic<std::uint64_t> sweeps{0};
+    };
+
+    // 解析与校验不在热路径上，不分片
+    std::atomic<std::uint64_t> parse_ns{0};
+    std::atomic<std::uint64_t> validation_ns{0};
+
+    void add(std::atomic<std::uint64_t>& counter, std::uint64_t value) {
+        counter.fetch_add(value, std::memory_order_relaxed);
+    }
+
+    void record_decision(int res, std::uint64_t ns) {
+        Shard& s = local();
+        add(s.decisions[res], 1);
+        add(s.decision_ns, ns);
+    }
+
+    void record_safety(std::uint64_t ns, std::uint64_t scans, std::uint64_t blocked, std::uint64_t rounds) {
+        Shard& s = local();
+        add(s.safety_checks, 1);
+        add(s.safety_ns, ns);
+        add(s.iterations, scans);
+        add(s.requeues, blocked);
+        add(s.sweeps, rounds);
+    }
+
+    MetricsTotals totals() const {
+        auto get = [](const std::atomic<std::uint64_t>& c) { return c.load(std::memory_order_relaxed); };
+        MetricsTotals t;
+        for (const Shard& s : shards) {
+            for (int k = 0; k < 3; ++k) t.decisions[k] += get(s.decisions[k]);
+            t.decision_ns += get(s.decision_ns);
+            t.safety_checks += get(s.safety_checks);
+            t.safety_ns += get(s.safety_ns);
+            t.iterations += get(s.iterations);
+            t.requeues += get(s.requeues);
+            t.sweeps += get(s.sweeps);
+        }
+        return t;
+    }
+
+    void reset() {
+        parse_ns.store(0, std::memory_order_relaxed);
+        validation_ns.store(0, std::memory_order_relaxed);
+        for (Shard& s : shards) {
+            for (auto* c : {&s.decisions[0], &s.decisions[1], &s.decisions[2], &s.decision_ns,
+                            &s.safety_checks, &s.safety_ns, &s.iterations, &s.requeues, &s.sweeps}) {
+                c->store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    void write_json(std::ostream& os) const {
+        const MetricsTotals t = totals();
+        auto ms = [](std::uint64_t ns) { return ns / 1e6; };
+        const std::uint64_t fail = t.decisions[0], wait = t.decisions[1], success = t.decisions[2];
+        const std::uint64_t total = fail + wait + success;
+        const double seconds = t.decision_ns / 1e9;
+        os << "{\"parse_ms\": " << ms(parse_ns.load(std::memory_order_relaxed))
+           << ", \"validation_ms\": " << ms(validation_ns.load(std::memory_order_relaxed))
+           << ", \"decisions\": {\"total\": " << total
+           << ", \"success\": " << success
+           << ", \"wait\": " << wait
+           << ", \"fail\": " << fail
+           << ", \"time_ms\": " << ms(t.decision_ns)
+           << ", \"per_second\": " << (seconds > 0 ? total / seconds : 0) << "}"
+           << ", \"safety\": {\"checks\": " << t.safety_checks
+           << ", \"time_ms\": " << ms(t.safety_ns)
+           << ", \"iterations\": " << t.iterations
+           << ", \"requeues\": " << t.requeues
+           << ", \"sweeps\": " << t.sweeps << "}}";
+    }
+
+private:
+    Shard shards[shard_count];
+    std::atomic<std::size_t> next_shard{0};
+
+    Shard& local() {
+        thread_local const std::size_t k = next_shard.fetch_add(1, std::memory_order_relaxed) % shard_count;
+        return shards[k];
+    }
+};
+
+inline BankerMetrics banker_metrics;
+
+
+// 作用域计时，析构时累加到指定计时器
+class ScopedTimer {
+public:
+    explicit ScopedTimer(std::atomic<std::uint64_t>& counter) : counter(counter), start(metrics_clock::now()) {}
+    ~ScopedTimer() {
+        counter.fetch_add(elapsed_ns(start), std::memory_order_relaxed);
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    std::atomic<std::uint64_t>& counter;
+    metrics_clock::time_point start;
+};
+
+
+#endif // METRICS_HPP
@@ -0,0 +1,210 @@
+#ifndef SAFETY_HPP
+#define SAFETY_HPP
+
+#include "utils.hpp"
+#include "matrix.hpp"
+#include "metrics.hpp"
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <utility>
+
+// 基于资源索引的安全性检查。
+//
+// blocked_on[i] 是进程 i 第一个 need[i][j] > work[j] 的资源 j。work 只增不减，已满足的资源
+// 不会重新变为不足，所以每次复查都从 blocked_on 处继续向后扫描，每个进程的 need 行总共只扫描一遍。
+//
+// 检查分两个阶段：
+//   1. 按进程号顺序轮询未完成进程（与循环队列相同，但从 blocked_on 续扫），可完成者立即归还资源。
+//      当轮询不再有进展，或轮数达到 log2(n) 时转入第二阶段，轮询的总开销不超过 O(n log n)。
+//   2. 剩余进程挂入所阻塞资源的等待堆（按 need[i][j] 升序的最小堆）。work 增大后只检查等待堆非空的
+//      资源，从堆顶弹出已被满足的进程并续扫，只唤醒确实可能被解除阻塞的进程。
+// 总代价为 O(nm + H log n)，H 为挂堆次数，而非循环队列在最坏情况下的 O(n^2 m)。
+//
+// 所有临时数组保存在对象内部，重复调用不再分配内存。结果与 is_safe_queue 一致：
+// 可完成进程集合随 work 单调增大，与完成顺序无关。
+class SafetyChecker {
+public:
+    bool is_safe(
+        const ResourceVector& available,
+        const ResourceMatrix& allocation,
+        const ResourceMatrix& need
+    ) {
+        DEBUG_PRINT("Checking if the system is in a safe state (indexed)...");
+        work = available;
+        overlay_id = -1;
+        return run(allocation, need);
+    }
+
+    // 不修改状态，检查把 request 分配给进程 id 之后是否安全。
+    // 试分配只体现在 work 与进程 id 的覆盖行上，其余行直接读取原矩阵，无需复制整个状态
+    bool is_safe_after(
+        const ResourceVector& available,
+        const ResourceMatrix& allocation,
+        const ResourceMatrix& need,
+        int id,
+        const ResourceVector& request
+    ) {
+        DEBUG_PRINT("Checking if the system stays safe after granting process " << id << "...");
+        const std::size_t stride = available.stride();
+        work = available;
+        vec_sub(work.data(), request.data(), stride);
+        overlay_need = request;
+        overlay_alloc = request;
+        for (std::size_t j = 0; j < stride; ++j) {
+            overlay_need[j] = need(id, j) - request[j];
+            overlay_alloc[j] = allocation(id, j) + request[j];
+        }
+        overlay_id = id;
+        return run(allocation, need);
+    }
+
+    // 通用规约：从 initial_work 出发，只考虑 processes 中的进程，反复完成 need 不超过 work 的进程并归还其 allocation。
+    // 返回后 processes 只保留无法完成的进程（保持原有顺序），final_work() 为规约结束时的 work。
+    // 死锁检测以当前请求矩阵代替 need 调用
+    void reduce(
+        const ResourceVector& initial_work,
+        const ResourceMatrix& allocation,
+        const ResourceMatrix& need,
+        std::vector<int>& processes
+    ) {
+        work = initial_work;
+        overlay_id = -1;
+        unfinished.assign(processes.begin(), processes.end());
+        reduce_unfinished(allocation, need);
+        std::size_t kept = 0;
+        for (int id : processes) {
+            if (blocked_on[id] != work.stride()) processes[kept++] = id;
+        }
+        processes.resize(kept);
+    }
+
+    const ResourceVector& final_work() const {
+        return work;
+    }
+
+private:
+    ResourceVector work;
+    ResourceVector overlay_need;                           // 覆盖行：试分配后进程 overlay_id 的 need
+    ResourceVector overlay_alloc;                          // 覆盖行：试分配后进程 overlay_id 的 allocation
+    int overlay_id = -1;
+    std::vector<std::size_t> blocked_on;                   // 每个进程当前阻塞于的资源类
+    std::vector<int> unfinished;                           // 第一阶段尚未完成的进程
+    std::vector<int> woken;                                // 已出堆、待续扫 need 行的进程
+    std::vector<std::vector<std::pair<int, int>>> waiting; // 每类资源上被阻塞的 (need, 进程号) 最小堆
+    std::vector<int> active;                               // 等待堆非空的资源类
+    std::size_t finished = 0;
+    std::uint64_t scans = 0;                               // 本次检查的统计，结束时并入 banker_metrics
+    std::uint64_t blocked = 0;
+    std::uint64_t rounds = 0;
+
+    const int* need_row(const ResourceMatrix& need, int id) const {
+        return id == overlay_id ? overlay_need.data() : need.row(id);
+    }
+    const int* alloc_row(const ResourceMatrix& allocation, int id) const {
+        return id == overlay_id ? overlay_alloc.data() : allocation.row(id);
+    }
+
+    // work 已就绪，对全部进程执行两阶段检查
+    bool run(const ResourceMatrix& allocation, const ResourceMatrix& need) {
+        const std::size_t n = need.rows();
+        unfinished.resize(n);
+        for (std::size_t i = 0; i < n; ++i) unfinished[i] = i;
+        reduce_unfinished(allocation, need);
+
+        if (finished < n) {
+            DEBUG_PRINT("System is not in a safe state.");
+            return false;
+        }
+        DEBUG_PRINT("System is in a safe state.");
+        return true;
+    }
+
+    // 对 unfinished 中的进程执行两阶段规约。结束后 blocked_on[i] == stride 当且仅当进程 i 已完成
+    void reduce_unfinished(const ResourceMatrix& allocation, const ResourceMatrix& need) {
+        const auto start = metrics_clock::now();
+        scans = blocked = rounds = 0;
+        const std::size_t m = work.size();
+        blocked_on.assign(need.rows(), 0);
+        woken.clear();
+        active.clear();
+        waiting.resize(m);
+        for (auto& heap : waiting) heap.clear();
+        finished = 0;
+
+        for (std::size_t bound = unfinished.size(); bound > 0 && !unfinished.empty(); bound >>= 1) {
+            const std::size_t before = finished;
+            std::size_t kept = 0;
+            ++rounds;
+            for (int id : unfinished) {
+                if (scan(id, need_row(need, id))) {
+                    finish(id, alloc_row(allocation, id));
+                } else {
+                    unfinished[kept++] = id;
+                }
+            }
+            unfinished.resize(kept);
+            if (finished == before) break;
+        }
+
+        for (int id : unfinished) {
+            park(id, need_row(need, id));
+        }
+        while (wake()) {
+            for (int id : woken) {
+                if (scan(id, need_row(need, id))) {
+                    finish(id, alloc_row(allocation, id));
+                } else {
+                    park(id, need_row(need, id));
+                }
+            }
+            woken.clear();
+        }
+        banker_metrics.record_safety(elapsed_ns(start), scans, blocked, rounds);
+    }
+
+    // 从 blocked_on[id] 继续扫描，返回进程是否已可完成。补齐列恒为 0，扫描到 stride 即表示全部满足
+    bool scan(std::size_t id, const int* row) {
+        const std::size_t j = vec_first_gt(row, work.data(), blocked_on[id], work.stride());
+        blocked_on[id] = j;
+        ++scans;
+        blocked += j != work.stride();
+        return j == work.stride();
+    }
+
+    void park(std::size_t id, const int* row) {
+        const std::size_t j = blocked_on[id];
+        if (waiting[j].empty()) active.push_back(j);
+        waiting[j].emplace_back(row[j], id);
+        std::push_heap(waiting[j].begin(), waiting[j].end(), std::greater<>());
+    }
+
+    void finish(std::size_t id, const int* alloc) {
+        vec_add(work.data(), alloc, work.stride());
+        ++finished;
+        DEBUG_PRINT("\t\tTask " << id << " finished, work updated. \ttasks finished: " << finished);
+    }
+
+    // 从各等待堆弹出已被当前 work 满足的进程，返回是否有进程被唤醒
+    bool wake() {
+        for (std::size_t k = 0; k < active.size();) {
+            const int j = active[k];
+            auto& heap = waiting[j];
+            while (!heap.empty() && heap.front().first <= work[j]) {
+                std::pop_heap(heap.begin(), heap.end(), std::greater<>());
+                woken.push_back(heap.back().second);
+                heap.pop_back();
+            }
+            if (heap.empty()) {
+                active[k] = active.back();
+                active.pop_back();
+            } else {
+                ++k;
+            }
+        }
+        return !woken.empty();
+    }
+};
+
+
+#endif // SAFETY_HPP
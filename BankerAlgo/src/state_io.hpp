@@ -0,0 +1,308 @@
+#ifndef STATE_IO_HPP
+#define STATE_IO_HPP
+
+#include "matrix.hpp"
+#include <iostream>
+#include <string>
+#include <cstring>
+#include <cstdint>
+#include <cerrno>
+#include <charconv>
+#include <algorithm>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// 状态文件：Available、Allocation、Need 三部分，代替命令行参数传入大规模状态。
+//
+// 文本格式与命令行参数相同，三部分各占一行，例如
+//   3,3,2
+//   0,1,0;2,0,0;3,0,2
+//   7,4,3;1,2,2;6,0,0
+// 整个文件 mmap 后用 std::from_chars 就地解析，数字直接写入矩阵缓冲区，不产生中间字符串与嵌套 vector。
+// 数字两侧可有空格，空行被忽略。
+//
+// 二进制快照为 SnapshotHeader 后接 available、allocation、need 三块缓冲区的原样内容（含补齐列，
+// 本机字节序），加载时按 header 分配好矩阵后直接 read 进缓冲区，无需任何解析。
+// 保存先写临时文件再 rename，中途崩溃不会留下不完整的快照。
+// 两种格式在加载时按文件开头的魔数自动区分。
+
+
+constexpr char SNAPSHOT_MAGIC[8] = {'B', 'A', 'N', 'K', 'S', 'N', 'A', 'P'};
+constexpr std::uint32_t SNAPSHOT_VERSION = 1;
+
+struct SnapshotHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t int_size;     // sizeof(int)，防止在不同平台间误读
+    std::uint64_t processes;
+    std::uint64_t resources;
+    std::uint64_t stride;       // 每行 int 个数，须等于 padded_width(resources)
+};
+
+
+// 只读映射整个文件，析构时解除映射
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path) {
+        fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("Failed to open " + path + ": " + std::strerror(errno));
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            close(fd);
+            throw std::runtime_error("Failed to stat " + path + ": " + std::strerror(errno));
+        }
+        length = st.st_size;
+        if (length == 0) return;
+        void* p = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p == MAP_FAILED) {
+            close(fd);
+            throw std::runtime_error("Failed to map " + path + ": " + std::strerror(errno));
+        }
+        madvise(p, length, MADV_SEQUENTIAL);
+        addr = static_cast<const char*>(p);
+    }
+
+    ~MappedFile() {
+        if (addr) munmap(const_cast<char*>(addr), length);
+        close(fd);
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* begin() const { return addr; }
+    const char* end() const { return addr + length; }
+    std::size_t size() const { return length; }
+
+private:
+    int fd = -1;
+    const char* addr = nullptr;
+    std::size_t length = 0;
+};
+
+
+// ---- 文本格式 ----
+
+class TextStateParser {
+public:
+    TextStateParser(const char* begin, const char* end) : p(begin), end(end) {}
+
+    void parse(ResourceVector& available, ResourceMatrix& allocation, ResourceMatrix& need) {
+        const char* line = next_line();
+        const std::size_t m = line == line_end ? 0 : std::count(line, line_end, ',') + 1;
+        available = ResourceVector(m);
+        parse_row(available.data(), m, "Available");
+        expect_line_end("Available");
+
+        line = next_line();
+        const std::size_t n = line == line_end ? 0 : std::count(line, line_end, ';') + 1;
+        allocation = ResourceMatrix(n, m);
+        parse_matrix(allocation, "Allocation");
+
+        need = ResourceMatrix(n, m);
+        next_line();
+        parse_matrix(need, "Need");
+    }
+
+private:
+    const char* p;
+    const char* end;
+    const char* line_end = nullptr;
+
+    // 跳过空行，返回下一行的开头并设置 line_end
+    const char* next_line() {
+        while (p < end && (*p == '\n' || *p == '\r' || *p == ' ' || *p == '\t')) ++p;
+        if (p == end) {
+            throw std::runtime_error("State file must contain Available, Allocation and Need lines");
+        }
+        line_end = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        if (!line_end) line_end = end;
+        while (line_end > p && (line_end[-1] == '\r' || line_end[-1] == ' ' || line_end[-1] == '\t')) --line_end;
+        return p;
+    }
+
+    void skip_blanks() {
+        while (p < line_end && (*p == ' ' || *p == '\t')) ++p;
+    }
+
+    void parse_row(int* row, std::size_t m, const char* what) {
+        for (std::size_t j = 0; j < m; ++j) {
+            if (j) expect(',', what);
+            skip_blanks();
+            auto [next, ec] = std::from_chars(p, line_end, row[j]);
+            if (ec != std::errc()) {
+                throw std::runtime_error(std::string("Invalid number in ") + what);
+            }
+            p = next;
+            skip_blanks();
+        }
+    }
+
+    void parse_matrix(ResourceMatrix& matrix, const char* what) {
+        if (static_cast<std::size_t>(std::count(p, line_end, ';') + 1) != matrix.rows()) {
+            throw std::runtime_error("Allocation and Need matrices must have the same number of rows");
+        }
+        for (std::size_t i = 0; i < matrix.rows(); ++i) {
+            if (i) expect(';', what);
+            parse_row(matrix.row(i), matrix.cols(), what);
+        }
+        expect_line_end(what);
+    }
+
+    void expect(char c, const char* what) {
+        if (p == line_end || *p != c) {
+            throw std::runtime_error(std::string(what) + " rows must have the same number of columns as Available");
+        }
+        ++p;
+    }
+
+    void expect_line_end(const char* what) {
+        if (p != line_end) {
+            throw std::runtime_error(std::string("Unexpected trailing data in ") + what);
+        }
+        p = line_end;
+    }
+};
+
+void write_row(std::ostream& os, const int* row, std::size_t size) {
+    for (std::size_t j = 0; j < size; ++j) {
+        if (j) os << ',';
+        os << row[j];
+    }
+}
+
+void write_text_state(std::ostream& os, const ResourceVector& available,
+                      const ResourceMatrix& allocation, const ResourceMatrix& need) {
+    write_row(os, available.data(), available.size());
+    os << '\n';
+    for (const ResourceMatrix* matrix : {&allocation, &need}) {
+        for (std::size_t i = 0; i < matrix->rows(); ++i) {
+            if (i) os << ';';
+            write_row(os, matrix->row(i), matrix->cols());
+        }
+        os << '\n';
+    }
+}
+
+
+// ---- 二进制快照 ----
+
+void read_exact(int fd, void* buf, std::size_t size, const std::string& path) {
+    char* dst = static_cast<char*>(buf);
+    while (size > 0) {
+        ssize_t n = read(fd, dst, size);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) {
+            throw std::runtime_error("Snapshot " + path + " is truncated");
+        }
+        dst += n;
+        size -= n;
+    }
+}
+
+void write_exact(int fd, const void* buf, std::size_t size, const std::string& path) {
+    const char* src = static_cast<const char*>(buf);
+    while (size > 0) {
+        ssize_t n = write(fd, src, size);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) {
+            throw std::runtime_error("Failed to write " + path + ": " + std::strerror(errno));
+        }
+        src += n;
+        size -= n;
+    }
+}
+
+void load_snapshot(int fd, const std::string& path,
+                   ResourceVector& available, ResourceMatrix& allocation, ResourceMatrix& need) {
+    SnapshotHeader h;
+    read_exact(fd, &h, sizeof(h), path);
+    if (std::memcmp(h.magic, SNAPSHOT_MAGIC, sizeof(h.magic)) != 0 || h.version != SNAPSHOT_VERSION
+        || h.int_size != sizeof(int) || h.stride != padded_width(h.resources)) {
+        throw std::runtime_error("Unsupported snapshot format in " + path);
+    }
+    struct stat st;
+    const std::uint64_t body = (1 + 2 * h.processes) * h.stride * sizeof(int);
+    if (fstat(fd, &st) != 0 || static_cast<std::uint64_t>(st.st_size) != sizeof(h) + body) {
+        throw std::runtime_error("Snapshot " + path + " has an unexpected size");
+    }
+    available = ResourceVector(h.resources);
+    allocation = ResourceMatrix(h.processes, h.resources);
+    need = ResourceMatrix(h.processes, h.resources);
+    read_exact(fd, available.data(), available.stride() * sizeof(int), path);
+    read_exact(fd, allocation.data(), allocation.rows() * allocation.stride() * sizeof(int), path);
+    read_exact(fd, need.data(), need.rows() * need.stride() * sizeof(int), path);
+
+    // 向量运算依赖补齐列为 0，不信任文件内容
+    for (std::size_t j = available.size(); j < available.stride(); ++j) available[j] = 0;
+    for (ResourceMatrix* matrix : {&allocation, &need}) {
+        for (std::size_t i = 0; i < matrix->rows(); ++i) {
+            for (std::size_t j = matrix->cols(); j < matrix->stride(); ++j) (*matrix)(i, j) = 0;
+        }
+    }
+}
+
+void save_snapshot(const std::string& path, const ResourceVector& available,
+                   const ResourceMatrix& allocation, const ResourceMatrix& need) {
+    const std::string tmp = path + ".tmp";
+    int fd = open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to create " + tmp + ": " + std::strerror(errno));
+    }
+    SnapshotHeader h{};
+    std::memcpy(h.magic, SNAPSHOT_MAGIC, sizeof(h.magic));
+    h.version = SNAPSHOT_VERSION;
+    h.int_size = sizeof(int);
+    h.processes = allocation.rows();
+    h.resources = available.size();
+    h.stride = available.stride();
+    try {
+        write_exact(fd, &h, sizeof(h), tmp);
+        write_exact(fd, available.data(), available.stride() * sizeof(int), tmp);
+        write_exact(fd, allocation.data(), allocation.rows() * allocation.stride() * sizeof(int), tmp);
+        write_exact(fd, need.data(), need.rows() * need.stride() * sizeof(int), tmp);
+        if (fsync(fd) != 0) {
+            throw std::runtime_error("Failed to sync " + tmp + ": " + std::strerror(errno));
+        }
+    } catch (...) {
+        close(fd);
+        unlink(tmp.c_str());
+        throw;
+    }
+    close(fd);
+    if (rename(tmp.c_str(), path.c_str()) != 0) {
+        unlink(tmp.c_str());
+        throw std::runtime_error("Failed to rename " + tmp + ": " + std::strerror(errno));
+    }
+}
+
+
+// 按魔数区分快照与文本，失败时抛出 std::runtime_error
+void load_state(const std::string& path, ResourceVector& available, ResourceMatrix& allocation, ResourceMatrix& need) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to open " + path + ": " + std::strerror(errno));
+    }
+    char magic[sizeof(SNAPSHOT_MAGIC)];
+    if (pread(fd, magic, sizeof(magic), 0) == sizeof(magic) && std::memcmp(magic, SNAPSHOT_MAGIC, sizeof(magic)) == 0) {
+        try {
+            load_snapshot(fd, path, available, allocation, need);
+        } catch (...) {
+            close(fd);
+            throw;
+        }
+        close(fd);
+        return;
+    }
+    close(fd);
+    MappedFile file(path);
+    TextStateParser(file.begin(), file.end()).parse(available, allocation, need);
+}
+
+
+#endif // STATE_IO_HPP
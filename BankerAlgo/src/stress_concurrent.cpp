@@ -0,0 +1,281 @@
+#include "concurrent.hpp"
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <random>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include <type_traits>
+
+
+// 对照组：用一把大锁包住 banker_allocate，WAIT 时在条件变量上等待释放
+class LockedBanker {
+public:
+    LockedBanker(ResourceVector available, ResourceMatrix allocation, ResourceMatrix need)
+        : available(std::move(available)),
+          allocation(std::move(allocation)),
+          need(std::move(need)) {}
+
+    result request(int id, const ResourceVector& request) {
+        std::unique_lock<std::mutex> lk(mutex);
+        result res;
+        while ((res = banker_allocate(available, allocation, need, request, id)) == result::WAIT) {
+            cv.wait(lk);
+        }
+        return res;
+    }
+
+    result try_request(int id, const ResourceVector& request) {
+        std::lock_guard<std::mutex> lk(mutex);
+        return banker_allocate(available, allocation, need, request, id);
+    }
+
+    bool release(int id, const ResourceVector& release) {
+        std::lock_guard<std::mutex> lk(mutex);
+        bool ok = banker_release(available, allocation, need, release, id);
+        cv.notify_all();
+        return ok;
+    }
+
+    void snapshot(ResourceVector& available_out, ResourceMatrix& allocation_out, ResourceMatrix& need_out) {
+        std::lock_guard<std::mutex> lk(mutex);
+        available_out = available;
+        allocation_out = allocation;
+        need_out = need;
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable cv;
+    ResourceVector available;
+    ResourceMatrix allocation;
+    ResourceMatrix need;
+};
+
+
+struct Workload {
+    std::size_t processes_per_thread;
+    std::size_t resources;
+    std::size_t rounds_per_thread;   // 每轮：一个进程分块申请到最大需求后全部归还
+    unsigned seed;
+};
+
+// 每个线程轮流驱动自己名下的进程，同一时刻只有一个进程持有资源，
+// 因而系统始终存在可完成的持有者，阻塞请求终会被满足。
+template <typename Banker>
+void client(Banker& banker, const ResourceMatrix& max_claim, std::size_t thread_id,
+            const Workload& w, std::size_t& ops, bool& ok) {
+    std::mt19937 gen(w.seed * 7919 + thread_id);
+    const std::size_t m = w.resources;
+    ResourceVector chunk(m), held(m);
+    for (std::size_t round = 0; round < w.rounds_per_thread; ++round) {
+        const int id = thread_id * w.processes_per_thread + round % w.processes_per_thread;
+        const int* claim = max_claim.row(id);
+        for (std::size_t j = 0; j < m; ++j) held[j] = 0;
+        bool full = false;
+        while (!full) {
+            full = true;
+            for (std::size_t j = 0; j < m; ++j) {
+                const int remain = claim[j] - held[j];
+                chunk[j] = remain > 0 ? std::uniform_int_distribution<int>(1, remain)(gen) : 0;
+                full &= chunk[j] == remain;
+            }
+            result res = gen() % 4 == 0 ? banker.try_request(id, chunk) : result::WAIT;
+            if (res == result::WAIT) res = banker.request(id, chunk);
+            ++ops;
+            if (res != result::SUCCESS) {
+                ok = false;
+                return;
+            }
+            vec_add(held.data(), chunk.data(), held.stride());
+        }
+        ok &= banker.release(id, held);
+        ++ops;
+    }
+}
+
+template <typename Banker>
+double run(std::size_t threads, const Workload& w, const ResourceVector& total,
+           const ResourceMatrix& max_claim, bool& ok, ConcurrentStats* stats = nullptr) {
+    const std::size_t n = max_claim.rows();
+    Banker banker(total, ResourceMatrix(n, w.resources), max_claim);
+    std::vector<std::size_t> ops(threads, 0);
+    std::vector<char> thread_ok(threads, 1);
+    std::vector<std::thread> pool;
+
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t t = 0; t < threads; ++t) {
+        pool.emplace_back([&, t] {
+            bool good = true;
+            client(banker, max_claim, t, w, ops[t], good);
+            thread_ok[t] = good;
+        });
+    }
+    for (auto& th : pool) th.join();
+    auto end = std::chrono::steady_clock::now();
+
+    // 全部归还后应恢复初始状态
+    ResourceVector available;
+    ResourceMatrix allocation, need;
+    banker.snapshot(available, allocation, need);
+    for (std::size_t t = 0; t < threads; ++t) ok &= thread_ok[t] != 0;
+    ok &= vec_le(available.data(), total.data(), total.stride()) && vec_le(total.data(), available.data(), total.stride());
+    for (std::size_t i = 0; i < n; ++i) {
+        ok &= vec_le(need.row(i), max_claim.row(i), need.stride()) && vec_le(max_claim.row(i), need.row(i), need.stride());
+    }
+    if constexpr (std::is_same_v<Banker, ConcurrentBanker>) {
+        if (stats) *stats = banker.stats();
+    }
+
+    std::size_t total_ops = 0;
+    for (auto c : ops) total_ops += c;
+    return total_ops / std::chrono::duration<double>(end - start).count();
+}
+
+
+// 整批提交非阻塞请求，逐个结果及最终状态须与按同一顺序执行 banker_allocate 一致
+bool matches_sequential(
+    const ResourceVector& available, const ResourceMatrix& allocation, const ResourceMatrix& need,
+    const std::vector<int>& ids, const std::vector<ResourceVector>& requests, ConcurrentStats* stats = nullptr
+) {
+    ConcurrentBanker banker(available, allocation, need);
+    std::vector<result> batched = banker.try_requests(ids, requests);
+    if (stats) *stats = banker.stats();
+
+    ResourceVector seq_available = available;
+    ResourceMatrix seq_allocation = allocation, seq_need = need;
+    bool ok = true;
+    for (std::size_t k = 0; k < ids.size(); ++k) {
+        ok &= batched[k] == banker_allocate(seq_available, seq_allocation, seq_need, requests[k], ids[k]);
+    }
+    ResourceVector out_available;
+    ResourceMatrix out_allocation, out_need;
+    banker.snapshot(out_available, out_allocation, out_need);
+    ok &= out_available.to_vector() == seq_available.to_vector();
+    ok &= out_allocation.to_nested() == seq_allocation.to_nested() && out_need.to_nested() == seq_need.to_nested();
+    return ok;
+}
+
+// 确定性检查：整批不安全、回退到逐个检查时，对 need 的检查须基于回滚后的行。
+//   - 同一进程的两个请求若都只按试分配后的 need 检查，会被一起授予而超出最大需求；
+//   - 反之，同一进程后一个请求在第一遍中超出试分配后的 need，回滚后可能并未超出
+bool check_batch_fallback() {
+    ConcurrentStats stats;
+    bool ok = matches_sequential(
+        ResourceVector(std::vector<int>{6}), ResourceMatrix({{0}, {0}, {4}}, 1), ResourceMatrix({{4}, {10}, {5}}, 1),
+        {1, 0, 0}, {ResourceVector(std::vector<int>{3}), ResourceVector(std::vector<int>{4}), ResourceVector(std::vector<int>{2})},
+        &stats);
+    ok &= stats.batches == 1 && stats.fallbacks == 1;
+    ok &= matches_sequential(
+        ResourceVector(std::vector<int>{4, 5}),
+        ResourceMatrix({{1, 2}, {0, 2}, {1, 1}, {1, 2}}, 2), ResourceMatrix({{5, 2}, {5, 1}, {5, 1}, {1, 1}}, 2),
+        {3, 3, 1, 1},
+        {ResourceVector(std::vector<int>{0, 4}), ResourceVector(std::vector<int>{0, 1}),
+         ResourceVector(std::vector<int>{4, 1}), ResourceVector(std::vector<int>{3, 1})},
+        &stats);
+    ok &= stats.batches == 1 && stats.fallbacks == 1;
+    return ok;
+}
+
+// 含负分量的请求与归还须被拒绝，且不改变状态
+bool check_negative_vectors() {
+    const ResourceVector available(std::vector<int>{3, 3});
+    const ResourceMatrix allocation({{1, 1}, {2, 0}}, 2);
+    const ResourceMatrix need({{2, 2}, {1, 3}}, 2);
+    const ResourceVector negative(std::vector<int>{-5, 0});
+
+    ConcurrentBanker banker(available, allocation, need);
+    bool ok = !banker.release(0, negative);
+    ok &= banker.try_request(1, negative) == result::FAIL;
+    ok &= banker.try_requests({0, 1}, {negative, negative}) == std::vector<result>{result::FAIL, result::FAIL};
+
+    ResourceVector out_available;
+    ResourceMatrix out_allocation, out_need;
+    banker.snapshot(out_available, out_allocation, out_need);
+    ok &= out_available.to_vector() == available.to_vector();
+    ok &= out_allocation.to_nested() == allocation.to_nested() && out_need.to_nested() == need.to_nested();
+    return ok;
+}
+
+// 随机整批提交非阻塞请求，逐个结果及最终状态须与按同一顺序执行 banker_allocate 一致
+bool check_random_batches(unsigned seed, int rounds) {
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<int> dist(0, 4);
+    bool ok = true;
+    for (int r = 0; r < rounds && ok; ++r) {
+        const std::size_t n = 2 + gen() % 4, m = 1 + gen() % 3;
+        ResourceVector available(m);
+        ResourceMatrix allocation(n, m), need(n, m);
+        for (std::size_t j = 0; j < m; ++j) available[j] = dist(gen) + 2;
+        for (std::size_t i = 0; i < n; ++i) {
+            for (std::size_t j = 0; j < m; ++j) {
+                allocation(i, j) = dist(gen) / 2;
+                need(i, j) = dist(gen);
+            }
+        }
+        if (!is_safe(available, allocation, need)) continue;
+
+        std::vector<int> ids;
+        std::vector<ResourceVector> requests;
+        for (std::size_t k = 0, count = 2 + gen() % 6; k < count; ++k) {
+            ids.push_back(gen() % n);
+            requests.emplace_back(m);
+            for (std::size_t j = 0; j < m; ++j) requests.back()[j] = dist(gen) / 2 + dist(gen) / 4;
+        }
+        ok &= matches_sequential(available, allocation, need, ids, requests);
+    }
+    return ok;
+}
+
+
+int main(int argc, char *argv[]) {
+    if (argc < 4) {
+        std::cerr << "Usage: " << argv[0] << " <processes_per_thread> <resources> <rounds_per_thread> [max_threads] [seed]" << std::endl;
+        return 1;
+    }
+    Workload w;
+    w.processes_per_thread = std::stoul(argv[1]);
+    w.resources = std::stoul(argv[2]);
+    w.rounds_per_thread = std::stoul(argv[3]);
+    const std::size_t max_threads = argc > 4 ? std::stoul(argv[4]) : 2 * std::thread::hardware_concurrency();
+    w.seed = argc > 5 ? std::stoul(argv[5]) : 2025;
+
+    bool all_ok = check_batch_fallback() && check_negative_vectors() && check_random_batches(w.seed, 20000);
+    std::cout << "batch checks: " << (all_ok ? "OK" : "FAILED") << std::endl;
+    for (std::size_t threads = 1; threads <= max_threads; threads *= 2) {
+        const std::size_t n = threads * w.processes_per_thread;
+        const std::size_t m = w.resources;
+        std::mt19937 gen(w.seed + threads);
+        std::uniform_int_distribution<int> dist(0, 6);
+        ResourceMatrix max_claim(n, m);
+        ResourceVector total(m);
+        for (std::size_t i = 0; i < n; ++i) {
+            for (std::size_t j = 0; j < m; ++j) {
+                max_claim(i, j) = dist(gen);
+                total[j] = std::max(total[j], max_claim(i, j));
+            }
+        }
+        // 总量约为单个进程最大需求的 threads/2 倍，制造足够的竞争
+        for (std::size_t j = 0; j < m; ++j) total[j] *= std::max<std::size_t>(1, threads / 2);
+
+        bool ok_batched = true, ok_locked = true;
+        ConcurrentStats stats;
+        double batched = run<ConcurrentBanker>(threads, w, total, max_claim, ok_batched, &stats);
+        double locked = run<LockedBanker>(threads, w, total, max_claim, ok_locked);
+        all_ok &= ok_batched && ok_locked;
+
+        std::cout << "threads: " << threads
+                  << "\tbatched: " << static_cast<long>(batched) << " ops/s"
+                  << " (avg batch " << static_cast<double>(stats.operations) / std::max<std::size_t>(1, stats.batches)
+                  << ", checks " << stats.safety_checks << ", fallbacks " << stats.fallbacks << ")"
+                  << "\tlocked: " << static_cast<long>(locked) << " ops/s"
+                  << "\t" << (ok_batched && ok_locked ? "OK" : "INVARIANT VIOLATED") << std::endl;
+    }
+
+    if (!all_ok) {
+        std::cerr << "Stress test failed!" << std::endl;
+        return 1;
+    }
+    return 0;
+}
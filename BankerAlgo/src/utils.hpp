@@ -5,6 +5,15 @@
 #include <sstream>
 #include <vector>
 #include <queue>
+#include <mutex>
+
+#ifdef DEBUG
+std::mutex mutex_debug;
+#define DEBUG_PRINT(x) \
+    do { std::lock_guard<std::mutex> lk(mutex_debug); std::cout << x << std::endl; } while(0)
+#else
+#define DEBUG_PRINT(x) do {} while(0)
+#endif
 
 
 template <typename T>
@@ -0,0 +1,139 @@
+#ifndef WHATIF_HPP
+#define WHATIF_HPP
+
+#include "banker.hpp"
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+// 批量假设分析：对同一状态快照，独立判断每个候选请求 (id, request) 现在能否被安全授予。
+//
+// 每个候选都按 banker_allocate 的规则给出 SUCCESS / WAIT / FAIL，但不修改快照：
+// 试分配只体现在 SafetyChecker::is_safe_after 的 work 与覆盖行上，候选之间共享只读快照。
+// 候选由常驻线程池并行处理，调用线程也参与计算；各线程持有自己的 SafetyChecker 临时数组。
+// 进程号越界或维度不符的候选视为 FAIL。evaluate() 不可重入，同一时刻只应由一个线程调用。
+
+
+struct Candidate {
+    int id;
+    ResourceVector request;
+};
+
+
+class WhatIfEvaluator {
+public:
+    explicit WhatIfEvaluator(std::size_t threads = std::thread::hardware_concurrency()) {
+        for (std::size_t t = 1; t < threads; ++t) {
+            workers.emplace_back(&WhatIfEvaluator::worker, this);
+        }
+    }
+
+    ~WhatIfEvaluator() {
+        {
+            std::lock_guard<std::mutex> lk(mutex);
+            stop = true;
+        }
+        cv_job.notify_all();
+        for (auto& t : workers) t.join();
+    }
+
+    WhatIfEvaluator(const WhatIfEvaluator&) = delete;
+    WhatIfEvaluator& operator=(const WhatIfEvaluator&) = delete;
+
+    std::vector<result> evaluate(
+        const ResourceVector& available,
+        const ResourceMatrix& allocation,
+        const ResourceMatrix& need,
+        const std::vector<Candidate>& candidates
+    ) {
+        std::vector<result> results(candidates.size(), result::FAIL);
+        {
+            std::lock_guard<std::mutex> lk(mutex);
+            job = Job{&available, &allocation, &need, &candidates, &results};
+            next = 0;
+            busy = workers.size();
+            ++generation;
+        }
+        cv_job.notify_all();
+
+        drain(caller_checker);
+
+        std::unique_lock<std::mutex> lk(mutex);
+        cv_done.wait(lk, [this] { return busy == 0; });
+        job = Job();
+        return results;
+    }
+
+    std::size_t threads() const {
+        return workers.size() + 1;
+    }
+
+private:
+    struct Job {
+        const ResourceVector* available = nullptr;
+        const ResourceMatrix* allocation = nullptr;
+        const ResourceMatrix* need = nullptr;
+        const std::vector<Candidate>* candidates = nullptr;
+        std::vector<result>* results = nullptr;
+    };
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable cv_job;
+    std::condition_variable cv_done;
+    Job job;
+    std::atomic<std::size_t> next{0};
+    std::size_t busy = 0;
+    std::size_t generation = 0;
+    bool stop = false;
+    SafetyChecker caller_checker;
+
+    void worker() {
+        SafetyChecker checker;
+        std::size_t seen = 0;
+        std::unique_lock<std::mutex> lk(mutex);
+        while (true) {
+            cv_job.wait(lk, [&] { return stop || generation != seen; });
+            if (stop) return;
+            seen = generation;
+            lk.unlock();
+            drain(checker);
+            lk.lock();
+            if (--busy == 0) cv_done.notify_one();
+        }
+    }
+
+    // 按下标领取候选，直到全部处理完
+    void drain(SafetyChecker& checker) {
+        const std::size_t total = job.candidates->size();
+        for (std::size_t k = next.fetch_add(1); k < total; k = next.fetch_add(1)) {
+            (*job.results)[k] = evaluate_one(checker, (*job.candidates)[k]);
+        }
+    }
+
+    result evaluate_one(SafetyChecker& checker, const Candidate& c) const {
+        const ResourceVector& available = *job.available;
+        const ResourceMatrix& allocation = *job.allocation;
+        const ResourceMatrix& need = *job.need;
+        if (c.id < 0 || c.id >= static_cast<int>(need.rows()) || c.request.size() != available.size()
+            || !vec_nonneg(c.request.data(), c.request.stride())) {
+            return result::FAIL;
+        }
+        if (c.request.empty()) {
+            return result::SUCCESS;
+        }
+        const std::size_t stride = available.stride();
+        if (!vec_le(c.request.data(), need.row(c.id), stride)) {
+            return result::FAIL;
+        }
+        if (!vec_le(c.request.data(), available.data(), stride)) {
+            return result::WAIT;
+        }
+        return checker.is_safe_after(available, allocation, need, c.id, c.request) ? result::SUCCESS : result::WAIT;
+    }
+};
+
+
+#endif // WHATIF_HPP